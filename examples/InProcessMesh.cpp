@@ -0,0 +1,29 @@
+
+#include "mesh_reader.hpp"
+
+#include <iostream>
+
+int main()
+{
+    // Access each partition of a decomposed mesh in-process without writing
+    // the mesh to file
+    imr::mesh_reader reader("decomposed.msh",
+                            imr::NodalOrdering::Local,
+                            imr::IndexingBase::Zero,
+                            imr::distributed::interprocess);
+
+    for (int partition = 0; partition < reader.numberOfPartitions(); ++partition)
+    {
+        auto const local = reader.local_mesh(partition);
+
+        std::cout << "Partition " << local->number() << " has " << local->coordinates().size()
+                  << " nodes\n";
+
+        for (auto const& group : local->element_groups())
+        {
+            std::cout << "  " << group.name << " with " << group.size() << " elements of type "
+                      << group.type_id << "\n";
+        }
+    }
+    std::cout << "Done!\n";
+}
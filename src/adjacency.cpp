@@ -0,0 +1,166 @@
+
+#include "adjacency.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace imr
+{
+csr_graph transpose(csr_graph const& graph, std::int64_t const columns)
+{
+    auto const rows = static_cast<std::int64_t>(graph.rows());
+
+    csr_graph result;
+    result.offsets.assign(columns + 1, 0);
+    result.indices.resize(graph.indices.size());
+
+    // Count the entries in each column
+#pragma omp parallel for
+    for (std::int64_t row = 0; row < rows; ++row)
+    {
+        for (auto const column : graph.row(row))
+        {
+#pragma omp atomic
+            ++result.offsets[column + 1];
+        }
+    }
+
+    std::partial_sum(begin(result.offsets), end(result.offsets), begin(result.offsets));
+
+    // Scatter each row into the columns, claiming a position with an atomic cursor
+    std::vector<std::int64_t> cursor(begin(result.offsets), end(result.offsets) - 1);
+
+#pragma omp parallel for
+    for (std::int64_t row = 0; row < rows; ++row)
+    {
+        for (auto const column : graph.row(row))
+        {
+            std::int64_t position;
+#pragma omp atomic capture
+            position = cursor[column]++;
+
+            result.indices[position] = row;
+        }
+    }
+
+    // The order within a row depends on the thread schedule
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::int64_t column = 0; column < columns; ++column)
+    {
+        std::sort(begin(result.indices) + result.offsets[column],
+                  begin(result.indices) + result.offsets[column + 1]);
+    }
+    return result;
+}
+
+csr_graph node_graph(csr_graph const& element_nodes, csr_graph const& node_elements)
+{
+    auto const nodes = static_cast<std::int64_t>(node_elements.rows());
+
+    csr_graph result;
+    result.offsets.assign(nodes + 1, 0);
+
+    // Count the distinct neighbours of each node, where the marker holds the
+    // last row that visited a node to avoid a container for each row
+#pragma omp parallel
+    {
+        std::vector<std::int64_t> marker(nodes, -1);
+
+#pragma omp for schedule(dynamic, 1024)
+        for (std::int64_t node = 0; node < nodes; ++node)
+        {
+            std::int64_t count = 0;
+
+            for (auto const element : node_elements.row(node))
+            {
+                for (auto const neighbour : element_nodes.row(element))
+                {
+                    if (marker[neighbour] != node)
+                    {
+                        marker[neighbour] = node;
+                        ++count;
+                    }
+                }
+            }
+            result.offsets[node + 1] = count;
+        }
+    }
+
+    std::partial_sum(begin(result.offsets), end(result.offsets), begin(result.offsets));
+
+    result.indices.resize(result.offsets.back());
+
+#pragma omp parallel
+    {
+        std::vector<std::int64_t> marker(nodes, -1);
+
+#pragma omp for schedule(dynamic, 1024)
+        for (std::int64_t node = 0; node < nodes; ++node)
+        {
+            auto position = result.offsets[node];
+
+            for (auto const element : node_elements.row(node))
+            {
+                for (auto const neighbour : element_nodes.row(element))
+                {
+                    if (marker[neighbour] != node)
+                    {
+                        marker[neighbour]          = node;
+                        result.indices[position++] = neighbour;
+                    }
+                }
+            }
+            std::sort(begin(result.indices) + result.offsets[node],
+                      begin(result.indices) + result.offsets[node + 1]);
+        }
+    }
+    return result;
+}
+
+std::vector<std::int32_t> colour_elements(csr_graph const& element_nodes,
+                                          csr_graph const& node_elements)
+{
+    auto const elements = static_cast<std::int64_t>(element_nodes.rows());
+
+    std::vector<std::int32_t> colours(elements, -1);
+
+    // Number of elements of each colour
+    std::vector<std::int64_t> colour_sizes;
+
+    // The last element that found each colour taken by a neighbour
+    std::vector<std::int64_t> taken;
+
+    for (std::int64_t element = 0; element < elements; ++element)
+    {
+        for (auto const node : element_nodes.row(element))
+        {
+            for (auto const neighbour : node_elements.row(node))
+            {
+                if (colours[neighbour] >= 0) taken[colours[neighbour]] = element;
+            }
+        }
+
+        std::int32_t colour = -1;
+
+        for (std::int32_t candidate = 0; candidate < static_cast<std::int32_t>(colour_sizes.size());
+             ++candidate)
+        {
+            if (taken[candidate] != element &&
+                (colour < 0 || colour_sizes[candidate] < colour_sizes[colour]))
+            {
+                colour = candidate;
+            }
+        }
+
+        if (colour < 0)
+        {
+            colour = colour_sizes.size();
+            colour_sizes.push_back(0);
+            taken.push_back(-1);
+        }
+        colours[element] = colour;
+        ++colour_sizes[colour];
+    }
+    return colours;
+}
+} // namespace imr
@@ -0,0 +1,51 @@
+
+#pragma once
+
+#include "span.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace imr
+{
+/// csr_graph stores a sparse graph (or sparse pattern) in compressed sparse
+/// row format where the columns of row i are indices[offsets[i], offsets[i + 1])
+struct csr_graph
+{
+    /// \return number of rows in the graph
+    std::size_t rows() const noexcept { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    /// \return column indices of the row
+    span<std::int64_t const> row(std::size_t const i) const noexcept
+    {
+        return {indices.data() + offsets[i], static_cast<std::size_t>(offsets[i + 1] - offsets[i])};
+    }
+
+    std::vector<std::int64_t> offsets{0};
+    std::vector<std::int64_t> indices;
+};
+
+/// Compute the transpose of a graph with a parallel counting sort, for
+/// example the node to element graph from the element to node graph.
+/// The columns of each row of the result are sorted.
+/// \param graph Graph to transpose
+/// \param columns Number of columns in graph (rows in the result)
+csr_graph transpose(csr_graph const& graph, std::int64_t const columns);
+
+/// Compute the nodal graph (sparsity pattern of a nodal matrix) where each
+/// node is connected to itself and every node of the elements containing it.
+/// The columns of each row of the result are sorted.
+/// \param element_nodes Element to node graph
+/// \param node_elements Node to element graph \sa transpose
+csr_graph node_graph(csr_graph const& element_nodes, csr_graph const& node_elements);
+
+/// Colour the elements such that no two elements sharing a node have the
+/// same colour.  Each element is greedily given the least used colour that
+/// is not taken by a neighbour, which keeps the colours balanced without
+/// using more colours than a first fit colouring.
+/// \param element_nodes Element to node graph
+/// \param node_elements Node to element graph \sa transpose
+/// \return colour of each element, numbered from zero
+std::vector<std::int32_t> colour_elements(csr_graph const& element_nodes,
+                                          csr_graph const& node_elements);
+} // namespace imr
@@ -0,0 +1,228 @@
+
+#include "block_compression.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <numeric>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace imr
+{
+namespace
+{
+/// gzip header with a single extra subfield holding the block sizes
+constexpr std::size_t header_size = 24;
+
+/// gzip trailer holding the CRC32 and the uncompressed size
+constexpr std::size_t trailer_size = 8;
+
+void store_le32(unsigned char* destination, std::uint32_t const value)
+{
+    for (int byte = 0; byte < 4; ++byte)
+    {
+        destination[byte] = static_cast<unsigned char>(value >> (8 * byte));
+    }
+}
+
+std::uint32_t load_le32(unsigned char const* source)
+{
+    return std::uint32_t(source[0]) | std::uint32_t(source[1]) << 8 |
+           std::uint32_t(source[2]) << 16 | std::uint32_t(source[3]) << 24;
+}
+
+bool is_block_header(unsigned char const* header)
+{
+    return header[0] == 0x1f && header[1] == 0x8b && header[2] == Z_DEFLATED && header[3] == 4 &&
+           header[10] == 12 && header[11] == 0 && header[12] == 'I' && header[13] == 'M' &&
+           header[14] == 8 && header[15] == 0;
+}
+
+std::string compress_block(char const* data, std::size_t const size, int const level)
+{
+    z_stream stream{};
+
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw std::runtime_error("Unable to initialise the zlib compressor");
+    }
+
+    std::string block(header_size + deflateBound(&stream, size) + trailer_size, '\0');
+
+    auto* const output = reinterpret_cast<unsigned char*>(&block[0]);
+
+    stream.next_in   = reinterpret_cast<unsigned char*>(const_cast<char*>(data));
+    stream.avail_in  = size;
+    stream.next_out  = output + header_size;
+    stream.avail_out = block.size() - header_size - trailer_size;
+
+    auto const status = deflate(&stream, Z_FINISH);
+    auto const compressed_size = stream.total_out;
+    deflateEnd(&stream);
+
+    if (status != Z_STREAM_END)
+    {
+        throw std::runtime_error("zlib was unable to compress the output block");
+    }
+
+    block.resize(header_size + compressed_size + trailer_size);
+
+    unsigned char const header[header_size] = {0x1f, 0x8b, Z_DEFLATED, 4, 0, 0, 0, 0, 0, 255,
+                                               12,   0,    'I',        'M', 8, 0};
+    std::copy(header, header + header_size, output);
+
+    store_le32(output + 16, block.size());
+    store_le32(output + 20, size);
+
+    auto const crc = crc32(0, reinterpret_cast<unsigned char const*>(data), size);
+
+    store_le32(output + header_size + compressed_size, crc);
+    store_le32(output + header_size + compressed_size + 4, size);
+
+    return block;
+}
+}
+
+std::string compress_blocks(std::string const& data, int const level, std::size_t const block_size)
+{
+    auto const blocks = static_cast<std::int64_t>(
+        std::max<std::size_t>(1, (data.size() + block_size - 1) / block_size));
+
+    std::vector<std::string> compressed(blocks);
+
+    // Exceptions cannot propagate out of a parallel region
+    std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::int64_t block = 0; block < blocks; ++block)
+    {
+        auto const first = block * block_size;
+        auto const size  = std::min(block_size, data.size() - first);
+
+        try
+        {
+            compressed[block] = compress_block(data.data() + first, size, level);
+        }
+        catch (...)
+        {
+#pragma omp critical
+            error = std::current_exception();
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+
+    std::string stream;
+    stream.reserve(std::accumulate(begin(compressed),
+                                   end(compressed),
+                                   std::size_t(0),
+                                   [](auto const sum, auto const& block) {
+                                       return sum + block.size();
+                                   }));
+    for (auto const& block : compressed)
+    {
+        stream += block;
+    }
+    return stream;
+}
+
+std::vector<compressed_block> block_index(char const* compressed, std::size_t const size)
+{
+    std::vector<compressed_block> index;
+
+    std::uint64_t offset = 0;
+
+    while (offset < size)
+    {
+        auto const* header = reinterpret_cast<unsigned char const*>(compressed + offset);
+
+        if (size - offset < header_size + trailer_size || !is_block_header(header))
+        {
+            throw std::runtime_error("Invalid compressed block header at offset " +
+                                     std::to_string(offset));
+        }
+
+        compressed_block const block{offset, load_le32(header + 16), load_le32(header + 20)};
+
+        if (block.size > size - offset || block.size < header_size + trailer_size)
+        {
+            throw std::runtime_error("Truncated compressed block at offset " +
+                                     std::to_string(offset));
+        }
+
+        index.push_back(block);
+
+        offset += block.size;
+    }
+    return index;
+}
+
+std::string decompress_block(char const* block, std::size_t const size)
+{
+    auto const* input = reinterpret_cast<unsigned char const*>(block);
+
+    if (size < header_size + trailer_size || !is_block_header(input))
+    {
+        throw std::runtime_error("Invalid compressed block header");
+    }
+
+    std::string data(load_le32(input + size - 4), '\0');
+
+    z_stream stream{};
+
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    {
+        throw std::runtime_error("Unable to initialise the zlib decompressor");
+    }
+
+    stream.next_in   = const_cast<unsigned char*>(input + header_size);
+    stream.avail_in  = size - header_size - trailer_size;
+    stream.next_out  = reinterpret_cast<unsigned char*>(&data[0]);
+    stream.avail_out = data.size();
+
+    auto const status = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+
+    auto const crc = crc32(0, reinterpret_cast<unsigned char const*>(data.data()), data.size());
+
+    if (status != Z_STREAM_END || crc != load_le32(input + size - trailer_size))
+    {
+        throw std::runtime_error("Corrupt compressed block");
+    }
+    return data;
+}
+
+std::string decompress_blocks(std::string const& compressed)
+{
+    auto const index = block_index(compressed.data(), compressed.size());
+
+    std::vector<std::string> blocks(index.size());
+
+    std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::int64_t block = 0; block < static_cast<std::int64_t>(index.size()); ++block)
+    {
+        try
+        {
+            blocks[block] = decompress_block(compressed.data() + index[block].offset,
+                                             index[block].size);
+        }
+        catch (...)
+        {
+#pragma omp critical
+            error = std::current_exception();
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+
+    std::string data;
+    for (auto const& block : blocks)
+    {
+        data += block;
+    }
+    return data;
+}
+} // namespace imr
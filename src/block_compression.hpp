@@ -0,0 +1,52 @@
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// \file block_compression.hpp
+/// Compression of output files into a sequence of independently compressed
+/// gzip members.  The concatenation is itself a valid gzip file, while the
+/// header of each member records the compressed and uncompressed size of the
+/// block in an extra field (subfield identifier 'I' 'M').  A consumer can
+/// therefore walk the block headers, seek to any block and decompress only
+/// that block without inflating the preceding data.
+
+namespace imr
+{
+/// Default number of uncompressed bytes in each block
+constexpr std::size_t compression_block_size = 1 << 20;
+
+/// Location of a block inside a compressed stream
+struct compressed_block
+{
+    /// Offset of the block from the start of the compressed stream
+    std::uint64_t offset;
+    /// Compressed size of the block including the gzip header and trailer
+    std::uint32_t size;
+    /// Size of the block after decompression
+    std::uint32_t uncompressed_size;
+};
+
+/// Compress the data into independent blocks in parallel
+/// \param data Uncompressed data
+/// \param level zlib compression level from 1 (fastest) to 9 (smallest)
+/// \param block_size Number of uncompressed bytes in each block
+/// \return compressed stream
+std::string compress_blocks(std::string const& data,
+                            int const level = 6,
+                            std::size_t const block_size = compression_block_size);
+
+/// Read the header of each block in the compressed stream
+/// \return the location and sizes of each block
+std::vector<compressed_block> block_index(char const* compressed, std::size_t const size);
+
+/// Decompress a single block
+/// \param block Pointer to the start of the block
+/// \param size Compressed size of the block from \sa block_index
+std::string decompress_block(char const* block, std::size_t const size);
+
+/// Decompress every block of the compressed stream in parallel
+std::string decompress_blocks(std::string const& compressed);
+} // namespace imr
@@ -0,0 +1,81 @@
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace imr
+{
+/// bounded_queue passes items between the threads of a pipeline.  A producer
+/// waits while the queue is full so a fast stage cannot run arbitrarily far
+/// ahead of a slow stage and hold its results in memory.
+template <typename T>
+class bounded_queue
+{
+public:
+    /// \param capacity Maximum number of items waiting in the queue
+    explicit bounded_queue(std::size_t const capacity) : m_capacity(capacity) {}
+
+    /// Add an item to the queue, waiting while the queue is full
+    /// \return false if the queue was closed and the item is discarded
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_not_full.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+
+        if (m_closed) return false;
+
+        m_items.push_back(std::move(item));
+
+        lock.unlock();
+        m_not_empty.notify_one();
+
+        return true;
+    }
+
+    /// Remove the oldest item from the queue, waiting while the queue is empty
+    /// \return false if the queue is closed and there are no items remaining
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+
+        if (m_items.empty()) return false;
+
+        item = std::move(m_items.front());
+        m_items.pop_front();
+
+        lock.unlock();
+        m_not_full.notify_one();
+
+        return true;
+    }
+
+    /// Stop accepting items.  The items already in the queue can still be
+    /// removed and every waiting thread is woken up.
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+
+    std::condition_variable m_not_full, m_not_empty;
+
+    std::deque<T> m_items;
+
+    std::size_t m_capacity;
+
+    bool m_closed = false;
+};
+} // namespace imr
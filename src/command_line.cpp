@@ -0,0 +1,168 @@
+
+#include "command_line.hpp"
+
+#include <stdexcept>
+
+namespace imr
+{
+namespace po = boost::program_options;
+
+void add_conversion_options(po::options_description& visible)
+{
+    visible.add_options()("zero-based",
+                          "Use zero based indexing for elements and nodes.  Default: "
+                          "one-based.");
+
+    visible.add_options()("local-ordering",
+                          "For distributed meshes, each processor has local indexing "
+                          "and a local to global mapping.  Default: global-ordering");
+
+    visible.add_options()("with-indices",
+                          "Write out extra indices (results in file size increase).  "
+                          "Default without-indices");
+
+    visible.add_options()("interprocess-format",
+                          "Write out shared process interfaces (only for decomposed meshes).  "
+                          "Default feti-format");
+
+    visible.add_options()("shared-node-interfaces",
+                          "Find the interfaces from the nodes of elements owned by different "
+                          "partitions.  Default use the ghost elements when present");
+
+    visible.add_options()("compress",
+                          "Compress the output files into independently compressed gzip "
+                          "blocks (.gz).  Default uncompressed");
+
+    visible.add_options()("single-file",
+                          "Write every partition into one container file (.meshes) with an "
+                          "index of partition offsets.  Default one file per partition");
+
+    visible.add_options()("pipeline",
+                          "Write out the files on a separate thread while the remaining "
+                          "partitions are converted.  Default write after each conversion");
+
+    visible.add_options()("stats",
+                          "Print the element, node and interface counts of each partition with "
+                          "the edge cut and the load imbalance, and write them out as JSON "
+                          "(.stats.json)");
+
+    visible.add_options()("coordinate-precision",
+                          po::value<std::string>()->default_value("double"),
+                          "Precision of the nodal coordinates written out as double, float or "
+                          "quantised (integers on a grid over the bounding box of the mesh)");
+
+    visible.add_options()("quantisation-bits",
+                          po::value<int>()->default_value(20),
+                          "Number of bits of the quantised coordinates from 1 to 52");
+
+    visible.add_options()("no-merge",
+                          "Keep coincident nodes with different ids.  Default merge the nodes "
+                          "within the merge tolerance");
+
+    visible.add_options()("merge-tolerance",
+                          po::value<double>()->default_value(1.0e-10),
+                          "Distance below which nodes are merged relative to the diagonal of "
+                          "the bounding box of the mesh");
+
+    visible.add_options()("refine",
+                          po::value<int>()->default_value(0),
+                          "Number of uniform refinements of the mesh before the conversion, "
+                          "where each refinement splits every edge in two");
+
+    visible.add_options()("halo-depth",
+                          po::value<int>()->default_value(0),
+                          "Number of element layers from neighbouring partitions to write "
+                          "out as a halo for each partition (only for decomposed meshes)");
+
+    visible.add_options()("skin",
+                          "Write out the exterior faces and the faces on the interfaces of "
+                          "each partition as element groups.  Default without skin");
+
+    visible.add_options()("adjacency",
+                          "Write out the node to element graph and the nodal graph of each "
+                          "partition in compressed sparse row format.  Default without graphs");
+
+    visible.add_options()("colour",
+                          "Order the elements of each element group by colour, where the "
+                          "elements of a colour do not share a node.  Default uncoloured");
+}
+
+po::positional_options_description input_files()
+{
+    po::positional_options_description p;
+    p.add("input-file", -1);
+
+    return p;
+}
+
+conversion_settings make_conversion(po::variables_map const& vm)
+{
+    conversion_settings settings;
+
+    settings.indexing = vm.count("zero-based") > 0 ? IndexingBase::Zero : IndexingBase::One;
+
+    settings.ordering = vm.count("local-ordering") > 0 ? NodalOrdering::Local
+                                                       : NodalOrdering::Global;
+
+    settings.format = vm.count("interprocess-format") > 0 ? distributed::interprocess
+                                                          : distributed::feti;
+
+    settings.interfaces = vm.count("shared-node-interfaces") > 0 ? interface_detection::shared_nodes
+                                                                 : interface_detection::ghost_tags;
+
+    settings.output.print_indices = vm.count("with-indices") > 0;
+    settings.output.compress      = vm.count("compress") > 0;
+    settings.output.single_file   = vm.count("single-file") > 0;
+    settings.output.pipeline      = vm.count("pipeline") > 0;
+    settings.output.statistics    = vm.count("stats") > 0;
+
+    auto const precision = vm["coordinate-precision"].as<std::string>();
+
+    if (precision == "float")
+    {
+        settings.output.precision = coordinate_precision::float32;
+    }
+    else if (precision == "quantised")
+    {
+        settings.output.precision = coordinate_precision::quantised;
+    }
+    else if (precision != "double")
+    {
+        throw std::domain_error("The coordinate precision " + precision +
+                                " is not double, float or quantised");
+    }
+    settings.output.quantisation_bits = vm["quantisation-bits"].as<int>();
+
+    settings.refinement_levels = vm["refine"].as<int>();
+
+    settings.merge_tolerance = vm.count("no-merge") > 0 ? 0.0
+                                                        : vm["merge-tolerance"].as<double>();
+
+    settings.contents.halo_depth = vm["halo-depth"].as<int>();
+    settings.contents.skin       = vm.count("skin") > 0;
+    settings.contents.adjacency  = vm.count("adjacency") > 0;
+    settings.contents.colour     = vm.count("colour") > 0;
+
+    if (vm.count("input-file"))
+    {
+        settings.input_files = vm["input-file"].as<std::vector<std::string>>();
+    }
+    return settings;
+}
+
+conversion_settings parse_conversion(std::vector<std::string> const& arguments)
+{
+    po::options_description options;
+
+    add_conversion_options(options);
+
+    options.add_options()("input-file", po::value<std::vector<std::string>>(), "input file");
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(arguments).options(options).positional(input_files()).run(),
+              vm);
+    po::notify(vm);
+
+    return make_conversion(vm);
+}
+} // namespace imr
@@ -0,0 +1,52 @@
+
+#pragma once
+
+#include "mesh_reader.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <string>
+#include <vector>
+
+namespace imr
+{
+/// Settings of a conversion given on the command line or in a request to the
+/// conversion server \sa serve
+struct conversion_settings
+{
+    NodalOrdering ordering = NodalOrdering::Global;
+
+    IndexingBase indexing = IndexingBase::One;
+
+    distributed format = distributed::feti;
+
+    interface_detection interfaces = interface_detection::ghost_tags;
+
+    output_options output;
+
+    partition_options contents;
+
+    /// Number of uniform refinements of the mesh \sa mesh_reader::refine
+    int refinement_levels = 0;
+
+    /// Tolerance for merging coincident nodes relative to the size of the
+    /// mesh, where zero disables the merge \sa mesh_reader::merge_nodes
+    double merge_tolerance = 0.0;
+
+    /// Gmsh files to convert
+    std::vector<std::string> input_files;
+};
+
+/// Add the options controlling a conversion to an options description
+void add_conversion_options(boost::program_options::options_description& options);
+
+/// \return description of the positional input files
+boost::program_options::positional_options_description input_files();
+
+/// \return settings from the parsed conversion options
+conversion_settings make_conversion(boost::program_options::variables_map const& vm);
+
+/// Parse the conversion options and the input files from a list of arguments
+/// \return settings of the conversion
+conversion_settings parse_conversion(std::vector<std::string> const& arguments);
+} // namespace imr
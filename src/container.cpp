@@ -0,0 +1,151 @@
+
+#include "container.hpp"
+
+#include "block_compression.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+
+namespace imr
+{
+namespace
+{
+constexpr char magic[8] = {'I', 'M', 'R', 'M', 'E', 'S', 'H', '\0'};
+
+constexpr std::uint32_t version = 1;
+
+constexpr std::uint32_t compressed_flag = 1;
+
+constexpr std::uint64_t fixed_header_size = 24;
+
+template <typename T>
+void append_le(std::string& buffer, T const value)
+{
+    for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+    {
+        buffer.push_back(static_cast<char>(value >> (8 * byte)));
+    }
+}
+
+template <typename T>
+T load_le(char const* source)
+{
+    T value = 0;
+    for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+    {
+        value |= T(static_cast<unsigned char>(source[byte])) << (8 * byte);
+    }
+    return value;
+}
+}
+
+void write_container(std::string const& file_name,
+                     std::vector<std::string> const& partitions,
+                     bool const is_compressed)
+{
+    std::string header(magic, magic + sizeof(magic));
+
+    append_le<std::uint32_t>(header, version);
+    append_le<std::uint32_t>(header, is_compressed ? compressed_flag : 0);
+    append_le<std::uint64_t>(header, partitions.size());
+
+    std::vector<std::uint64_t> offsets(partitions.size());
+
+    std::uint64_t offset = fixed_header_size + 16 * partitions.size();
+
+    for (std::size_t partition = 0; partition < partitions.size(); ++partition)
+    {
+        offsets[partition] = offset;
+
+        append_le<std::uint64_t>(header, offset);
+        append_le<std::uint64_t>(header, partitions[partition].size());
+
+        offset += partitions[partition].size();
+    }
+
+    {
+        std::ofstream writer(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+        writer.write(header.data(), header.size());
+
+        if (!writer)
+        {
+            throw std::domain_error("Output file " + file_name + " was not able to be written");
+        }
+    }
+
+    std::exception_ptr error;
+
+    // Each thread writes its partitions through a separate stream at the
+    // precomputed offset
+#pragma omp parallel for schedule(dynamic)
+    for (std::int64_t partition = 0; partition < static_cast<std::int64_t>(partitions.size());
+         ++partition)
+    {
+        std::fstream writer(file_name, std::ios::in | std::ios::out | std::ios::binary);
+        writer.seekp(offsets[partition]);
+        writer.write(partitions[partition].data(), partitions[partition].size());
+
+        if (!writer)
+        {
+#pragma omp critical
+            error = std::make_exception_ptr(
+                std::domain_error("Output file " + file_name + " was not able to be written"));
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+}
+
+container_reader::container_reader(std::string const& file_name) : m_file_name(file_name)
+{
+    std::ifstream reader(file_name, std::ios::in | std::ios::binary);
+
+    char header[fixed_header_size];
+
+    if (!reader.read(header, fixed_header_size) ||
+        !std::equal(magic, magic + sizeof(magic), header))
+    {
+        throw std::domain_error("Input file " + file_name + " is not a mesh container");
+    }
+
+    if (load_le<std::uint32_t>(header + 8) != version)
+    {
+        throw std::domain_error("Input file " + file_name + " has an unsupported version");
+    }
+
+    m_is_compressed = load_le<std::uint32_t>(header + 12) & compressed_flag;
+
+    std::string index(16 * load_le<std::uint64_t>(header + 16), '\0');
+
+    if (!reader.read(&index[0], index.size()))
+    {
+        throw std::domain_error("Input file " + file_name + " has a truncated index");
+    }
+
+    m_entries.resize(index.size() / 16);
+
+    for (std::size_t partition = 0; partition < m_entries.size(); ++partition)
+    {
+        m_entries[partition] = {load_le<std::uint64_t>(&index[16 * partition]),
+                                load_le<std::uint64_t>(&index[16 * partition + 8])};
+    }
+}
+
+std::string container_reader::read(std::size_t const partition) const
+{
+    auto const& entry = m_entries.at(partition);
+
+    std::ifstream reader(m_file_name, std::ios::in | std::ios::binary);
+
+    std::string data(entry.size, '\0');
+
+    if (!reader.seekg(entry.offset) || !reader.read(&data[0], entry.size))
+    {
+        throw std::domain_error("Unable to read partition " + std::to_string(partition) +
+                                " from " + m_file_name);
+    }
+    return m_is_compressed ? decompress_blocks(data) : data;
+}
+} // namespace imr
@@ -0,0 +1,67 @@
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// \file container.hpp
+/// A container file holds the output of every partition in a single file to
+/// avoid creating one file per partition.  All values are little endian.
+///
+/// | Bytes       | Content                                               |
+/// | :---------- | :---------------------------------------------------- |
+/// | 8           | Magic "IMRMESH\0"                                     |
+/// | 4           | Format version (1)                                    |
+/// | 4           | Flags (bit 0 set if the partitions are compressed)    |
+/// | 8           | Number of partitions N                                |
+/// | 16 * N      | Offset from the start of file and size of partition   |
+/// | ...         | Partition data                                        |
+///
+/// Each partition can then be read independently by seeking to its offset.
+
+namespace imr
+{
+/// Location of a partition inside a container file
+struct container_entry
+{
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/// Write the partition data into a container file.  The offsets are computed
+/// upfront so the partitions are written concurrently.
+/// \param file_name Name of the container file
+/// \param partitions Data for each partition
+/// \param is_compressed Flag if the data was compressed by \sa compress_blocks
+void write_container(std::string const& file_name,
+                     std::vector<std::string> const& partitions,
+                     bool const is_compressed);
+
+/// container_reader reads the index of a container file and provides
+/// access to the data of a single partition without reading the others
+class container_reader
+{
+public:
+    explicit container_reader(std::string const& file_name);
+
+    /// \return number of partitions in the container
+    std::size_t partitions() const noexcept { return m_entries.size(); }
+
+    /// \return true if the partition data is block compressed
+    bool is_compressed() const noexcept { return m_is_compressed; }
+
+    /// \return location of each partition in the file
+    std::vector<container_entry> const& entries() const noexcept { return m_entries; }
+
+    /// Read the data for a zero based partition number, decompressing if required
+    std::string read(std::size_t const partition) const;
+
+private:
+    std::string m_file_name;
+
+    std::vector<container_entry> m_entries;
+
+    bool m_is_compressed = false;
+};
+} // namespace imr
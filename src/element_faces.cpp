@@ -0,0 +1,142 @@
+
+#include "element_faces.hpp"
+
+#include "mesh_reader.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace imr
+{
+int element_dimension(int const type_id)
+{
+    switch (type_id)
+    {
+        case POINT: return 0;
+        case LINE2:
+        case LINE3:
+        case EDGE4:
+        case EDGE5:
+        case EDGE6: return 1;
+        case TRIANGLE3:
+        case QUADRILATERAL4:
+        case TRIANGLE6:
+        case QUADRILATERAL9:
+        case QUADRILATERAL8:
+        case TRIANGLE9:
+        case TRIANGLE10:
+        case TRIANGLE12:
+        case TRIANGLE15:
+        case TRIANGLE15_IC:
+        case TRIANGLE21: return 2;
+        case TETRAHEDRON4:
+        case HEXAHEDRON8:
+        case PRISM6:
+        case PYRAMID5:
+        case TETRAHEDRON10:
+        case HEXAHEDRON27:
+        case PRISM18:
+        case PYRAMID14:
+        case HEXAHEDRON20:
+        case PRISM15:
+        case PYRAMID13:
+        case TETRAHEDRON20:
+        case TETRAHEDRON35:
+        case TETRAHEDRON56:
+        case HEXAHEDRON64:
+        case HEXAHEDRON125: return 3;
+        default:
+            throw std::domain_error("The elementTypeId " + std::to_string(type_id) +
+                                    " is not implemented");
+    }
+    return -1;
+}
+
+std::vector<element_face> const& element_faces(int const type_id)
+{
+    static std::vector<element_face> const none;
+
+    // Edges of the two dimensional elements
+    static std::vector<element_face> const triangle3 = {{LINE2, 2, {0, 1}},
+                                                        {LINE2, 2, {1, 2}},
+                                                        {LINE2, 2, {2, 0}}};
+
+    static std::vector<element_face> const quadrilateral4 = {{LINE2, 2, {0, 1}},
+                                                             {LINE2, 2, {1, 2}},
+                                                             {LINE2, 2, {2, 3}},
+                                                             {LINE2, 2, {3, 0}}};
+
+    static std::vector<element_face> const triangle6 = {{LINE3, 2, {0, 1, 3}},
+                                                        {LINE3, 2, {1, 2, 4}},
+                                                        {LINE3, 2, {2, 0, 5}}};
+
+    static std::vector<element_face> const quadrilateral8 = {{LINE3, 2, {0, 1, 4}},
+                                                             {LINE3, 2, {1, 2, 5}},
+                                                             {LINE3, 2, {2, 3, 6}},
+                                                             {LINE3, 2, {3, 0, 7}}};
+
+    // Faces of the three dimensional elements
+    static std::vector<element_face> const tetrahedron4 = {{TRIANGLE3, 3, {0, 2, 1}},
+                                                           {TRIANGLE3, 3, {0, 1, 3}},
+                                                           {TRIANGLE3, 3, {0, 3, 2}},
+                                                           {TRIANGLE3, 3, {3, 1, 2}}};
+
+    static std::vector<element_face> const tetrahedron10 = {{TRIANGLE6, 3, {0, 2, 1, 6, 5, 4}},
+                                                            {TRIANGLE6, 3, {0, 1, 3, 4, 9, 7}},
+                                                            {TRIANGLE6, 3, {0, 3, 2, 7, 8, 6}},
+                                                            {TRIANGLE6, 3, {3, 1, 2, 9, 5, 8}}};
+
+    static std::vector<element_face> const hexahedron8 = {{QUADRILATERAL4, 4, {0, 3, 2, 1}},
+                                                          {QUADRILATERAL4, 4, {0, 1, 5, 4}},
+                                                          {QUADRILATERAL4, 4, {0, 4, 7, 3}},
+                                                          {QUADRILATERAL4, 4, {1, 2, 6, 5}},
+                                                          {QUADRILATERAL4, 4, {2, 3, 7, 6}},
+                                                          {QUADRILATERAL4, 4, {4, 5, 6, 7}}};
+
+    static std::vector<element_face> const hexahedron20 =
+        {{QUADRILATERAL8, 4, {0, 3, 2, 1, 9, 13, 11, 8}},
+         {QUADRILATERAL8, 4, {0, 1, 5, 4, 8, 12, 16, 10}},
+         {QUADRILATERAL8, 4, {0, 4, 7, 3, 10, 17, 15, 9}},
+         {QUADRILATERAL8, 4, {1, 2, 6, 5, 11, 14, 18, 12}},
+         {QUADRILATERAL8, 4, {2, 3, 7, 6, 13, 15, 19, 14}},
+         {QUADRILATERAL8, 4, {4, 5, 6, 7, 16, 18, 19, 17}}};
+
+    static std::vector<element_face> const hexahedron27 =
+        {{QUADRILATERAL9, 4, {0, 3, 2, 1, 9, 13, 11, 8, 20}},
+         {QUADRILATERAL9, 4, {0, 1, 5, 4, 8, 12, 16, 10, 21}},
+         {QUADRILATERAL9, 4, {0, 4, 7, 3, 10, 17, 15, 9, 22}},
+         {QUADRILATERAL9, 4, {1, 2, 6, 5, 11, 14, 18, 12, 23}},
+         {QUADRILATERAL9, 4, {2, 3, 7, 6, 13, 15, 19, 14, 24}},
+         {QUADRILATERAL9, 4, {4, 5, 6, 7, 16, 18, 19, 17, 25}}};
+
+    static std::vector<element_face> const prism6 = {{TRIANGLE3, 3, {0, 2, 1}},
+                                                     {TRIANGLE3, 3, {3, 4, 5}},
+                                                     {QUADRILATERAL4, 4, {0, 1, 4, 3}},
+                                                     {QUADRILATERAL4, 4, {0, 3, 5, 2}},
+                                                     {QUADRILATERAL4, 4, {1, 2, 5, 4}}};
+
+    static std::vector<element_face> const pyramid5 = {{TRIANGLE3, 3, {0, 1, 4}},
+                                                       {TRIANGLE3, 3, {3, 0, 4}},
+                                                       {TRIANGLE3, 3, {1, 2, 4}},
+                                                       {TRIANGLE3, 3, {2, 3, 4}},
+                                                       {QUADRILATERAL4, 4, {0, 3, 2, 1}}};
+
+    switch (type_id)
+    {
+        case TRIANGLE3: return triangle3;
+        case QUADRILATERAL4: return quadrilateral4;
+        case TRIANGLE6: return triangle6;
+        case QUADRILATERAL8:
+        case QUADRILATERAL9: return quadrilateral8;
+        case TETRAHEDRON4: return tetrahedron4;
+        case TETRAHEDRON10: return tetrahedron10;
+        case HEXAHEDRON8: return hexahedron8;
+        case HEXAHEDRON20: return hexahedron20;
+        case HEXAHEDRON27: return hexahedron27;
+        case PRISM6: return prism6;
+        case PYRAMID5: return pyramid5;
+        default: return none;
+    }
+    return none;
+}
+} // namespace imr
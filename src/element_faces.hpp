@@ -0,0 +1,29 @@
+
+#pragma once
+
+#include <vector>
+
+namespace imr
+{
+/// Face of an element given by the local node numbers of the element in the
+/// Gmsh ordering of the face element type.  The vertices are listed first and
+/// ordered such that the face normal points out of the element.
+struct element_face
+{
+    /// Gmsh element type of the face
+    int type_id;
+
+    /// Number of vertices of the face
+    int vertices;
+
+    /// Local node numbers of the face
+    std::vector<int> nodes;
+};
+
+/// \return topological dimension of a Gmsh element type
+int element_dimension(int const type_id);
+
+/// \return the faces of a three dimensional element type or the edges of a
+/// two dimensional element type.  This is empty for unsupported types.
+std::vector<element_face> const& element_faces(int const type_id);
+} // namespace imr
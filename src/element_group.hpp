@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include "index_array.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace imr
+{
+/// element_group stores the elements of a single physical name and element
+/// type for one partition with the nodal connectivity in a contiguous array
+struct element_group
+{
+    std::size_t size() const noexcept { return ids.size(); }
+
+    /// Physical name of the group
+    std::string name;
+
+    /// Gmsh element type \sa ELEMENT_TYPE_ID
+    std::int32_t type_id;
+
+    /// Number of nodes for each element in the group
+    std::int32_t nodes_per_element;
+
+    /// Element ids in the same order as the connectivity
+    std::vector<int> ids;
+
+    /// Nodal connectivity stored element by element
+    index_array node_indices;
+
+    /// Offsets of the colours when the elements are ordered by colour, where
+    /// the elements in [colour_offsets[c], colour_offsets[c + 1]) do not share
+    /// a node.  This is empty when the elements are not coloured.
+    std::vector<std::int64_t> colour_offsets;
+};
+} // namespace imr
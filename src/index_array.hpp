@@ -0,0 +1,136 @@
+
+#pragma once
+
+#include "span.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace imr
+{
+/// index_array is a contiguous array of node indices which is stored using
+/// 32 bit integers when every index is known to fit and 64 bit integers
+/// otherwise.  The width is fixed on construction and the data is accessed
+/// either through the widening operator[] or through \sa visit with a
+/// pointer range of the underlying integer type.
+class index_array
+{
+public:
+    /// \param is_narrow Store the indices using 32 bit integers
+    explicit index_array(bool const is_narrow = false) : m_is_narrow(is_narrow) {}
+
+    /// \return true if the indices are stored as 32 bit integers
+    bool is_narrow() const noexcept { return m_is_narrow; }
+
+    /// \return true if every index in [0, max_index] can be stored narrow
+    static bool fits_narrow(std::int64_t const max_index) noexcept
+    {
+        return max_index <= std::numeric_limits<std::int32_t>::max();
+    }
+
+    std::size_t size() const noexcept { return m_is_narrow ? m_narrow.size() : m_wide.size(); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    std::int64_t operator[](std::size_t const i) const noexcept
+    {
+        return m_is_narrow ? m_narrow[i] : m_wide[i];
+    }
+
+    std::int64_t front() const noexcept { return (*this)[0]; }
+
+    std::int64_t back() const noexcept { return (*this)[size() - 1]; }
+
+    void reserve(std::size_t const size)
+    {
+        m_is_narrow ? m_narrow.reserve(size) : m_wide.reserve(size);
+    }
+
+    void resize(std::size_t const size)
+    {
+        m_is_narrow ? m_narrow.resize(size) : m_wide.resize(size);
+    }
+
+    /// Append the indices in [first, last) converting to the storage type
+    template <typename Iterator>
+    void append(Iterator first, Iterator last)
+    {
+        if (m_is_narrow)
+        {
+            m_narrow.insert(end(m_narrow), first, last);
+        }
+        else
+        {
+            m_wide.insert(end(m_wide), first, last);
+        }
+    }
+
+    /// \return view of the indices if stored narrow, otherwise an empty view
+    span<std::int32_t const> narrow() const noexcept { return m_narrow; }
+
+    /// \return view of the indices if stored wide, otherwise an empty view
+    span<std::int64_t const> wide() const noexcept { return m_wide; }
+
+    /// \return pointer to the underlying storage which must be of index_type
+    template <typename index_type>
+    index_type* data() noexcept;
+
+    /// \return pointer to the underlying storage which must be of index_type
+    template <typename index_type>
+    index_type const* data() const noexcept;
+
+    /// Call function(first, last) with pointers to the underlying storage.
+    /// The function must have the same return type for both integer widths.
+    template <typename Function>
+    decltype(auto) visit(Function&& function)
+    {
+        return m_is_narrow ? function(m_narrow.data(), m_narrow.data() + m_narrow.size())
+                           : function(m_wide.data(), m_wide.data() + m_wide.size());
+    }
+
+    /// Call function(first, last) with pointers to the underlying storage
+    template <typename Function>
+    decltype(auto) visit(Function&& function) const
+    {
+        return m_is_narrow ? function(m_narrow.data(), m_narrow.data() + m_narrow.size())
+                           : function(m_wide.data(), m_wide.data() + m_wide.size());
+    }
+
+    /// Append the contents of another index array
+    void append(index_array const& other)
+    {
+        other.visit([this](auto const first, auto const last) { this->append(first, last); });
+    }
+
+private:
+    std::vector<std::int32_t> m_narrow;
+    std::vector<std::int64_t> m_wide;
+
+    bool m_is_narrow;
+};
+
+template <>
+inline std::int32_t* index_array::data<std::int32_t>() noexcept
+{
+    return m_narrow.data();
+}
+
+template <>
+inline std::int64_t* index_array::data<std::int64_t>() noexcept
+{
+    return m_wide.data();
+}
+
+template <>
+inline std::int32_t const* index_array::data<std::int32_t>() const noexcept
+{
+    return m_narrow.data();
+}
+
+template <>
+inline std::int64_t const* index_array::data<std::int64_t>() const noexcept
+{
+    return m_wide.data();
+}
+} // namespace imr
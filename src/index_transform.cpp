@@ -0,0 +1,64 @@
+
+#include "index_transform.hpp"
+
+// Emit one version of each function per instruction set and let the dynamic
+// loader choose the most capable one for the host.  The loops are written
+// such that they can be vectorised (including the gather for renumbering).
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define IMR_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+
+#ifndef IMR_TARGET_CLONES
+#define IMR_TARGET_CLONES
+#endif
+
+namespace imr
+{
+IMR_TARGET_CLONES
+void shift_indices(std::int32_t* first, std::int32_t* last, std::int32_t const offset) noexcept
+{
+    auto const size = last - first;
+    for (std::int64_t i = 0; i < size; ++i)
+    {
+        first[i] += offset;
+    }
+}
+
+IMR_TARGET_CLONES
+void shift_indices(std::int64_t* first, std::int64_t* last, std::int64_t const offset) noexcept
+{
+    auto const size = last - first;
+    for (std::int64_t i = 0; i < size; ++i)
+    {
+        first[i] += offset;
+    }
+}
+
+IMR_TARGET_CLONES
+void renumber_indices(std::int32_t* first,
+                      std::int32_t* last,
+                      std::int32_t const* lookup,
+                      std::int32_t const lookup_start) noexcept
+{
+    auto const size = last - first;
+    for (std::int64_t i = 0; i < size; ++i)
+    {
+        first[i] = lookup[first[i] - lookup_start];
+    }
+}
+
+IMR_TARGET_CLONES
+void renumber_indices(std::int64_t* first,
+                      std::int64_t* last,
+                      std::int64_t const* lookup,
+                      std::int64_t const lookup_start) noexcept
+{
+    auto const size = last - first;
+    for (std::int64_t i = 0; i < size; ++i)
+    {
+        first[i] = lookup[first[i] - lookup_start];
+    }
+}
+} // namespace imr
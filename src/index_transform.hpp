@@ -0,0 +1,33 @@
+
+#pragma once
+
+#include <cstdint>
+
+/// \file index_transform.hpp
+/// Bulk transformations over contiguous index arrays.  These are compiled for
+/// several instruction sets (AVX-512, AVX2 and a scalar fallback) where the
+/// compiler supports function multi-versioning and the best version is
+/// selected at runtime.
+
+namespace imr
+{
+/// Add the offset to each index in the range [first, last)
+void shift_indices(std::int32_t* first, std::int32_t* last, std::int32_t const offset) noexcept;
+
+/// Add the offset to each index in the range [first, last)
+void shift_indices(std::int64_t* first, std::int64_t* last, std::int64_t const offset) noexcept;
+
+/// Replace each index in the range [first, last) by lookup[index - lookup_start]
+/// \param lookup Table containing the new index for each index in the range
+/// \param lookup_start The smallest index contained in the lookup table
+void renumber_indices(std::int32_t* first,
+                      std::int32_t* last,
+                      std::int32_t const* lookup,
+                      std::int32_t const lookup_start) noexcept;
+
+/// Replace each index in the range [first, last) by lookup[index - lookup_start]
+void renumber_indices(std::int64_t* first,
+                      std::int64_t* last,
+                      std::int64_t const* lookup,
+                      std::int64_t const lookup_start) noexcept;
+} // namespace imr
@@ -1,5 +1,8 @@
 
+#include "command_line.hpp"
+#include "mesh_index.hpp"
 #include "mesh_reader.hpp"
+#include "server.hpp"
 
 #include <boost/program_options.hpp>
 #include <iostream>
@@ -18,21 +21,26 @@ int main(int argc, char* argv[])
 
         visible.add_options()("help", "Print help messages");
 
-        visible.add_options()("zero-based",
-                              "Use zero based indexing for elements and nodes.  Default: "
-                              "one-based.");
+        add_conversion_options(visible);
 
-        visible.add_options()("local-ordering",
-                              "For distributed meshes, each processor has local indexing "
-                              "and a local to global mapping.  Default: global-ordering");
+        visible.add_options()("index",
+                              "Write out the index of the partitions in each input file "
+                              "(.msh.idx) without converting the mesh");
 
-        visible.add_options()("with-indices",
-                              "Write out extra indices (results in file size increase).  "
-                              "Default without-indices");
+        visible.add_options()("partition",
+                              po::value<int>(),
+                              "Convert only the given zero based partition by reading its "
+                              "elements and nodes through the index, which is written out "
+                              "first if missing");
 
-        visible.add_options()("interprocess-format",
-                              "Write out shared process interfaces (only for decomposed meshes).  "
-                              "Default feti-format");
+        visible.add_options()("serve",
+                              po::value<std::string>(),
+                              "Keep the parsed meshes in memory and serve conversion requests "
+                              "on the given Unix socket");
+
+        visible.add_options()("cache-size",
+                              po::value<std::size_t>()->default_value(4),
+                              "Number of parsed meshes kept in memory when serving requests");
 
         po::options_description hidden("Hidden options");
 
@@ -41,16 +49,15 @@ int main(int argc, char* argv[])
         po::options_description cmdline_options;
         cmdline_options.add(visible).add(hidden);
 
-        po::positional_options_description p;
-        p.add("input-file", -1);
-
         po::variables_map vm;
 
         try
         {
-            po::store(
-                po::command_line_parser(argc, argv).options(cmdline_options).positional(p).run(),
-                vm);
+            po::store(po::command_line_parser(argc, argv)
+                          .options(cmdline_options)
+                          .positional(input_files())
+                          .run(),
+                      vm);
 
             if (vm.count("help") || argc < 2)
             {
@@ -70,26 +77,70 @@ int main(int argc, char* argv[])
             return 1;
         }
 
-        IndexingBase const indexing = vm.count("zero-based") > 0 ? IndexingBase::Zero
-                                                                 : IndexingBase::One;
+        if (vm.count("serve"))
+        {
+            serve(vm["serve"].as<std::string>(), vm["cache-size"].as<std::size_t>());
+            return 0;
+        }
 
-        NodalOrdering const ordering = vm.count("local-ordering") > 0 ? NodalOrdering::Local
-                                                                      : NodalOrdering::Global;
+        auto const settings = make_conversion(vm);
 
-        distributed const distributed_option = vm.count("interprocess-format") > 0
-                                                   ? distributed::interprocess
-                                                   : distributed::feti;
+        // A single partition is read without the rest of the mesh, which the
+        // statistics and the merge of coincident nodes depend on
+        if (vm.count("partition") && settings.output.statistics)
+        {
+            throw std::domain_error("--stats requires the complete mesh and cannot be used "
+                                    "with --partition");
+        }
+        if (vm.count("partition") && !vm["merge-tolerance"].defaulted())
+        {
+            throw std::domain_error("--merge-tolerance requires the complete mesh and cannot be "
+                                    "used with --partition");
+        }
 
         std::cout << "\nPerforming mesh conversion with "
-                  << (indexing == IndexingBase::Zero ? "zero" : "one")
+                  << (settings.indexing == IndexingBase::Zero ? "zero" : "one")
                   << " based indexing for node indices\n\n";
 
-        if (vm.count("input-file"))
+        if (!settings.input_files.empty())
         {
-            for (auto const& input : vm["input-file"].as<std::vector<std::string>>())
+            for (auto const& input : settings.input_files)
             {
-                mesh_reader reader(input, ordering, indexing, distributed_option);
-                reader.write(vm.count("with-indices") > 0);
+                if (vm.count("index"))
+                {
+                    write_mesh_index(build_mesh_index(input), input);
+
+                    std::cout << std::string(2, ' ') << "Finished writing out the index "
+                              << index_file_name(input) << "\n";
+                    continue;
+                }
+
+                if (vm.count("partition"))
+                {
+                    mesh_reader reader(input,
+                                       vm["partition"].as<int>(),
+                                       settings.ordering,
+                                       settings.indexing,
+                                       settings.format);
+
+                    reader.set_interface_detection(settings.interfaces);
+                    reader.refine(settings.refinement_levels);
+                    reader.set_partition_options(settings.contents);
+                    reader.write(settings.output);
+                    continue;
+                }
+
+                mesh_reader reader(input, settings.ordering, settings.indexing, settings.format);
+
+                reader.set_interface_detection(settings.interfaces);
+
+                if (auto const merged = reader.merge_nodes(settings.merge_tolerance))
+                {
+                    std::cout << std::string(2, ' ') << merged << " coincident nodes were merged\n";
+                }
+                reader.refine(settings.refinement_levels);
+                reader.set_partition_options(settings.contents);
+                reader.write(settings.output);
             }
         }
         else
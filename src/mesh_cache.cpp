@@ -0,0 +1,75 @@
+
+#include "mesh_cache.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+namespace imr
+{
+mesh_cache::mesh_cache(std::size_t const capacity) : m_capacity(std::max(capacity, std::size_t(1)))
+{
+}
+
+std::shared_ptr<mesh_reader> mesh_cache::get(std::string const& file_name,
+                                             int const refinement_levels,
+                                             double const merge_tolerance)
+{
+    struct stat status;
+
+    if (::stat(file_name.c_str(), &status) != 0)
+    {
+        throw std::domain_error("Input file " + file_name + " was not able to be opened");
+    }
+
+    std::int64_t const modified = std::int64_t(status.st_mtim.tv_sec) * 1000000000 +
+                                  status.st_mtim.tv_nsec;
+
+    std::int64_t const file_size = status.st_size;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto const found = std::find_if(begin(m_entries), end(m_entries), [&](auto const& cached) {
+        return cached.file_name == file_name && cached.refinement_levels == refinement_levels &&
+               cached.merge_tolerance == merge_tolerance;
+    });
+
+    if (found != end(m_entries))
+    {
+        if (found->modified == modified && found->file_size == file_size)
+        {
+            ++m_hits;
+
+            // Move to the front as the most recently used
+            m_entries.splice(begin(m_entries), m_entries, found);
+
+            return m_entries.front().reader;
+        }
+        m_entries.erase(found);
+    }
+
+    ++m_misses;
+
+    auto reader = std::make_shared<mesh_reader>(file_name,
+                                                NodalOrdering::Global,
+                                                IndexingBase::One,
+                                                distributed::feti);
+    reader->merge_nodes(merge_tolerance);
+    reader->refine(refinement_levels);
+
+    m_entries.push_front(
+        {file_name, refinement_levels, merge_tolerance, modified, file_size, reader});
+
+    if (m_entries.size() > m_capacity) m_entries.pop_back();
+
+    return reader;
+}
+
+std::size_t mesh_cache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_entries.size();
+}
+} // namespace imr
@@ -0,0 +1,72 @@
+
+#pragma once
+
+#include "mesh_reader.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace imr
+{
+/// mesh_cache keeps the most recently used parsed meshes so the same mesh can
+/// be converted repeatedly with different options without parsing it again.
+/// The meshes are cached by file name, the number of refinements and the
+/// merge tolerance.  A cached mesh is parsed again when the modification time
+/// or the size of the file has changed, and the least recently used mesh is
+/// discarded once the cache is full.
+class mesh_cache
+{
+public:
+    /// \param capacity Maximum number of meshes kept in the cache
+    explicit mesh_cache(std::size_t const capacity);
+
+    /// \return the parsed mesh of the file, parsing it if it is not cached or
+    /// the file has changed since it was parsed.  The format of the mesh is
+    /// the format of the previous use and should be set by the caller.
+    /// \param refinement_levels Number of uniform refinements of the mesh
+    /// \param merge_tolerance Relative tolerance to merge coincident nodes
+    /// before the refinement, where zero keeps the nodes \sa merge_nodes
+    std::shared_ptr<mesh_reader> get(std::string const& file_name,
+                                     int const refinement_levels = 0,
+                                     double const merge_tolerance = 0.0);
+
+    /// \return number of meshes in the cache
+    std::size_t size() const;
+
+    /// \return number of requests served from the cache
+    std::size_t hits() const noexcept { return m_hits; }
+
+    /// \return number of requests that required the file to be parsed
+    std::size_t misses() const noexcept { return m_misses; }
+
+private:
+    struct entry
+    {
+        std::string file_name;
+
+        int refinement_levels;
+
+        double merge_tolerance;
+
+        /// Modification time of the file in nanoseconds
+        std::int64_t modified;
+
+        std::int64_t file_size;
+
+        std::shared_ptr<mesh_reader> reader;
+    };
+
+    /// Entries from the most to the least recently used
+    std::list<entry> m_entries;
+
+    std::size_t m_capacity;
+
+    std::size_t m_hits = 0, m_misses = 0;
+
+    mutable std::mutex m_mutex;
+};
+} // namespace imr
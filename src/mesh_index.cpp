@@ -0,0 +1,483 @@
+
+#include "mesh_index.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <json/json.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace imr
+{
+namespace
+{
+/// Version of the index file, which is rebuilt when written by another version
+constexpr int index_version = 1;
+
+/// \return size of a file in bytes and its modification time in nanoseconds
+std::pair<std::uint64_t, std::int64_t> file_status(std::string const& file_name)
+{
+    struct stat status;
+
+    if (::stat(file_name.c_str(), &status) != 0)
+    {
+        throw std::domain_error("Mesh file " + file_name + " was not able to be opened");
+    }
+    std::int64_t const modified = std::int64_t(status.st_mtim.tv_sec) * 1000000000 +
+                                  status.st_mtim.tv_nsec;
+
+    return {status.st_size, modified};
+}
+
+/// Replace the values with the integers of a line
+void parse_integers(std::string const& line, std::vector<std::int64_t>& values)
+{
+    values.clear();
+
+    char const* first = line.c_str();
+    char* last        = nullptr;
+
+    while (true)
+    {
+        auto const value = std::strtoll(first, &last, 10);
+
+        if (last == first) break;
+
+        values.push_back(value);
+        first = last;
+    }
+}
+}
+
+std::string index_file_name(std::string const& mesh_file_name) { return mesh_file_name + ".idx"; }
+
+mesh_index build_mesh_index(std::string const& mesh_file_name, std::int64_t const block_size)
+{
+    mesh_index index;
+
+    std::tie(index.file_size, index.modified) = file_status(mesh_file_name);
+
+    std::ifstream file(mesh_file_name, std::ios::binary);
+
+    std::string line;
+    std::uint64_t offset = 0;
+
+    auto const next_line = [&]() {
+        auto const line_offset = offset;
+
+        if (!std::getline(file, line))
+        {
+            throw std::domain_error("Mesh file " + mesh_file_name + " ended unexpectedly");
+        }
+        offset += line.size() + 1;
+
+        // Files written on Windows end each line with a carriage return
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        return line_offset;
+    };
+
+    // Nodes of the elements owned by each partition and shared with another
+    std::map<std::pair<std::int32_t, std::int32_t>, std::set<std::int64_t>> shared_nodes;
+
+    // Node, owner and element run of each node of the partitioned elements
+    std::vector<std::tuple<std::int64_t, std::int32_t, std::int32_t>> node_owners;
+
+    std::vector<std::int64_t> values;
+
+    while (offset < index.file_size)
+    {
+        next_line();
+
+        if (line == "$PhysicalNames")
+        {
+            next_line();
+            auto const count = std::stoll(line);
+
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                next_line();
+
+                std::int32_t dimension, physical_id;
+                std::string name;
+
+                std::istringstream(line) >> dimension >> physical_id >> name;
+
+                // Extract the name from the quotes as the mesh reader does
+                name.erase(std::remove(begin(name), end(name), '\"'), end(name));
+
+                index.physical_names.emplace(physical_id, name);
+            }
+        }
+        else if (line == "$Nodes")
+        {
+            next_line();
+            auto const count = std::stoll(line);
+
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                auto const line_offset = next_line();
+
+                char* last = nullptr;
+
+                std::int64_t const id = std::strtoll(line.c_str(), &last, 10);
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    auto const coordinate = std::strtod(last, &last);
+
+                    if (i == 0) index.lower[axis] = index.upper[axis] = coordinate;
+
+                    index.lower[axis] = std::min(index.lower[axis], coordinate);
+                    index.upper[axis] = std::max(index.upper[axis], coordinate);
+                }
+
+                if (i % block_size == 0) index.node_blocks.push_back({line_offset, 0, id, id, id});
+
+                auto& block = index.node_blocks.back();
+
+                ++block.count;
+                block.min_id = std::min(block.min_id, id);
+                block.max_id = std::max(block.max_id, id);
+            }
+        }
+        else if (line == "$Elements")
+        {
+            next_line();
+            auto const count = std::stoll(line);
+
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                auto const line_offset = next_line();
+
+                parse_integers(line, values);
+
+                // id, type, number of tags, physical id, geometric id, number of
+                // partitions, owner, ghost partitions (negative) and the nodes
+                auto const tags = values.at(2);
+
+                std::int32_t owner = 1;
+                std::vector<std::int32_t> ghosts;
+
+                if (tags > 2)
+                {
+                    owner = values.at(6);
+
+                    for (std::int64_t tag = 7; tag < 3 + tags; ++tag)
+                    {
+                        ghosts.push_back(std::abs(values.at(tag)));
+                    }
+                    index.partitions = std::max<int>(index.partitions, owner);
+
+                    for (auto const ghost : ghosts)
+                    {
+                        index.partitions = std::max<int>(index.partitions, ghost);
+
+                        shared_nodes[{owner, ghost}].insert(begin(values) + 3 + tags, end(values));
+                    }
+                }
+
+                if (index.element_runs.empty() || index.element_runs.back().owner != owner ||
+                    index.element_runs.back().count == block_size)
+                {
+                    index.element_runs.push_back({line_offset, 0, owner, {}, {}, values.at(0)});
+                }
+
+                auto& run = index.element_runs.back();
+
+                if (tags > 2)
+                {
+                    std::int32_t const run_number = index.element_runs.size() - 1;
+
+                    for (auto node = begin(values) + 3 + tags; node != end(values); ++node)
+                    {
+                        node_owners.emplace_back(*node, owner, run_number);
+                    }
+                }
+
+                ++run.count;
+
+                std::vector<std::int32_t> run_ghosts;
+                std::set_union(begin(run.ghosts),
+                               end(run.ghosts),
+                               begin(ghosts),
+                               end(ghosts),
+                               std::back_inserter(run_ghosts));
+                run.ghosts = std::move(run_ghosts);
+            }
+        }
+    }
+
+    // Number the interface nodes in the order of the interfaces of the mesh reader
+    for (auto const& interface : shared_nodes)
+    {
+        auto const master = interface.first.first;
+        auto const slave  = interface.first.second;
+
+        if (master >= slave) continue;
+
+        auto const reverse = shared_nodes.find({slave, master});
+
+        if (reverse == end(shared_nodes)) continue;
+
+        std::vector<std::int64_t> intersection;
+        std::set_intersection(begin(interface.second),
+                              end(interface.second),
+                              begin(reverse->second),
+                              end(reverse->second),
+                              std::back_inserter(intersection));
+
+        index.interfaces.push_back({master, slave, index.interface_nodes});
+
+        index.interface_nodes += intersection.size();
+    }
+
+    // Group the owners by node to find the neighbours of each run and the
+    // nodes shared by each pair of partitions
+    std::sort(begin(node_owners), end(node_owners));
+
+    std::vector<std::set<std::int32_t>> neighbours(index.element_runs.size());
+    std::map<std::pair<std::int32_t, std::int32_t>, std::int64_t> shared_counts;
+
+    std::vector<std::int32_t> owners;
+
+    for (auto first = begin(node_owners); first != end(node_owners);)
+    {
+        auto const last = std::find_if(first, end(node_owners), [&](auto const& node_owner) {
+            return std::get<0>(node_owner) != std::get<0>(*first);
+        });
+
+        owners.clear();
+        for (auto i = first; i != last; ++i) owners.push_back(std::get<1>(*i));
+
+        owners.erase(std::unique(begin(owners), end(owners)), end(owners));
+
+        if (owners.size() > 1)
+        {
+            for (auto i = first; i != last; ++i)
+            {
+                for (auto const owner : owners)
+                {
+                    if (owner != std::get<1>(*i)) neighbours[std::get<2>(*i)].insert(owner);
+                }
+            }
+
+            for (auto master = begin(owners); master != end(owners); ++master)
+            {
+                for (auto slave = std::next(master); slave != end(owners); ++slave)
+                {
+                    ++shared_counts[{*master, *slave}];
+                }
+            }
+        }
+        first = last;
+    }
+
+    for (std::size_t run = 0; run < neighbours.size(); ++run)
+    {
+        index.element_runs[run].neighbours.assign(begin(neighbours[run]), end(neighbours[run]));
+    }
+
+    for (auto const& shared : shared_counts)
+    {
+        index.shared_node_interfaces.push_back(
+            {shared.first.first, shared.first.second, index.shared_interface_nodes});
+
+        index.shared_interface_nodes += shared.second;
+    }
+    return index;
+}
+
+void write_mesh_index(mesh_index const& index, std::string const& mesh_file_name)
+{
+    Json::Value event;
+
+    event["Version"]    = index_version;
+    event["FileSize"]   = Json::UInt64(index.file_size);
+    event["Modified"]   = Json::Int64(index.modified);
+    event["Partitions"] = index.partitions;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        event["BoundingBox"]["Lower"].append(index.lower[axis]);
+        event["BoundingBox"]["Upper"].append(index.upper[axis]);
+    }
+
+    event["PhysicalNames"] = Json::Value(Json::arrayValue);
+    for (auto const& physical_name : index.physical_names)
+    {
+        Json::Value name;
+        name["Id"]   = physical_name.first;
+        name["Name"] = physical_name.second;
+        event["PhysicalNames"].append(name);
+    }
+
+    for (auto const& block : index.node_blocks)
+    {
+        Json::Value entry;
+        entry["Offset"]  = Json::UInt64(block.offset);
+        entry["Count"]   = Json::Int64(block.count);
+        entry["MinId"]   = Json::Int64(block.min_id);
+        entry["MaxId"]   = Json::Int64(block.max_id);
+        entry["FirstId"] = Json::Int64(block.first_id);
+        event["NodeBlocks"].append(entry);
+    }
+
+    for (auto const& run : index.element_runs)
+    {
+        Json::Value entry;
+        entry["Offset"]  = Json::UInt64(run.offset);
+        entry["Count"]   = Json::Int64(run.count);
+        entry["Owner"]   = run.owner;
+        entry["FirstId"] = Json::Int64(run.first_id);
+        entry["Ghosts"]  = Json::Value(Json::arrayValue);
+        for (auto const ghost : run.ghosts) entry["Ghosts"].append(ghost);
+        entry["Neighbours"] = Json::Value(Json::arrayValue);
+        for (auto const neighbour : run.neighbours) entry["Neighbours"].append(neighbour);
+        event["ElementRuns"].append(entry);
+    }
+
+    event["Interfaces"] = Json::Value(Json::arrayValue);
+    for (auto const& interface : index.interfaces)
+    {
+        Json::Value entry;
+        entry["Master"]        = interface.master;
+        entry["Slave"]         = interface.slave;
+        entry["GlobalStartId"] = Json::Int64(interface.global_start_id);
+        event["Interfaces"].append(entry);
+    }
+    event["NumInterfaceNodes"] = Json::Int64(index.interface_nodes);
+
+    event["SharedNodeInterfaces"] = Json::Value(Json::arrayValue);
+    for (auto const& interface : index.shared_node_interfaces)
+    {
+        Json::Value entry;
+        entry["Master"]        = interface.master;
+        entry["Slave"]         = interface.slave;
+        entry["GlobalStartId"] = Json::Int64(interface.global_start_id);
+        event["SharedNodeInterfaces"].append(entry);
+    }
+    event["NumSharedInterfaceNodes"] = Json::Int64(index.shared_interface_nodes);
+
+    auto const file_name = index_file_name(mesh_file_name);
+
+    // Several processes may index the same mesh at once, so each writes to its
+    // own file and renames it into place, where readers see a complete index
+    char host[256] = {};
+    ::gethostname(host, sizeof(host) - 1);
+
+    auto const temporary_name = file_name + "." + host + "." + std::to_string(::getpid());
+
+    {
+        std::ofstream file(temporary_name, std::ios::binary);
+
+        Json::StyledWriter jsonwriter;
+        file << jsonwriter.write(event);
+        file.close();
+
+        if (!file)
+        {
+            std::remove(temporary_name.c_str());
+
+            throw std::domain_error("Index file " + file_name + " was not able to be written");
+        }
+    }
+
+    if (std::rename(temporary_name.c_str(), file_name.c_str()) != 0)
+    {
+        std::remove(temporary_name.c_str());
+
+        throw std::domain_error("Index file " + file_name + " was not able to be written");
+    }
+}
+
+mesh_index open_mesh_index(std::string const& mesh_file_name)
+{
+    std::ifstream file(index_file_name(mesh_file_name), std::ios::binary);
+
+    Json::Value event;
+
+    auto const status = file_status(mesh_file_name);
+
+    if (!file.is_open() || !Json::Reader().parse(file, event) ||
+        event["Version"].asInt() != index_version || event["FileSize"].asUInt64() != status.first ||
+        event["Modified"].asInt64() != status.second)
+    {
+        auto index = build_mesh_index(mesh_file_name);
+        write_mesh_index(index, mesh_file_name);
+        return index;
+    }
+
+    mesh_index index;
+
+    index.file_size  = event["FileSize"].asUInt64();
+    index.modified   = event["Modified"].asInt64();
+    index.partitions = event["Partitions"].asInt();
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        index.lower[axis] = event["BoundingBox"]["Lower"][axis].asDouble();
+        index.upper[axis] = event["BoundingBox"]["Upper"][axis].asDouble();
+    }
+
+    for (auto const& name : event["PhysicalNames"])
+    {
+        index.physical_names.emplace(name["Id"].asInt(), name["Name"].asString());
+    }
+
+    for (auto const& entry : event["NodeBlocks"])
+    {
+        index.node_blocks.push_back({entry["Offset"].asUInt64(),
+                                     entry["Count"].asInt64(),
+                                     entry["MinId"].asInt64(),
+                                     entry["MaxId"].asInt64(),
+                                     entry["FirstId"].asInt64()});
+    }
+
+    for (auto const& entry : event["ElementRuns"])
+    {
+        element_run run{entry["Offset"].asUInt64(),
+                        entry["Count"].asInt64(),
+                        entry["Owner"].asInt(),
+                        {},
+                        {},
+                        entry["FirstId"].asInt64()};
+
+        for (auto const& ghost : entry["Ghosts"]) run.ghosts.push_back(ghost.asInt());
+
+        for (auto const& neighbour : entry["Neighbours"])
+        {
+            run.neighbours.push_back(neighbour.asInt());
+        }
+
+        index.element_runs.push_back(std::move(run));
+    }
+
+    for (auto const& entry : event["Interfaces"])
+    {
+        index.interfaces.push_back({entry["Master"].asInt(),
+                                    entry["Slave"].asInt(),
+                                    entry["GlobalStartId"].asInt64()});
+    }
+    index.interface_nodes = event["NumInterfaceNodes"].asInt64();
+
+    for (auto const& entry : event["SharedNodeInterfaces"])
+    {
+        index.shared_node_interfaces.push_back({entry["Master"].asInt(),
+                                                entry["Slave"].asInt(),
+                                                entry["GlobalStartId"].asInt64()});
+    }
+    index.shared_interface_nodes = event["NumSharedInterfaceNodes"].asInt64();
+
+    return index;
+}
+} // namespace imr
@@ -0,0 +1,120 @@
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// \file mesh_index.hpp
+/// A sidecar index (the mesh file name with ".idx" appended) records where
+/// the nodes and the elements of each partition are located in a Gmsh file so
+/// a single partition is read by seeking to its elements and to the nodes they
+/// reference instead of parsing the complete file.  The index is stored as
+/// JSON and is rebuilt when the size or the modification time of the mesh
+/// file changes.
+
+namespace imr
+{
+/// Consecutive node lines in the mesh file
+struct node_block
+{
+    /// Offset of the first line of the block from the start of the file
+    std::uint64_t offset;
+
+    /// Number of nodes in the block
+    std::int64_t count;
+
+    /// Smallest and largest node id in the block
+    std::int64_t min_id, max_id;
+
+    /// Id of the first node of the block, which is checked after seeking
+    std::int64_t first_id;
+};
+
+/// Consecutive element lines in the mesh file with the same owner
+struct element_run
+{
+    /// Offset of the first line of the run from the start of the file
+    std::uint64_t offset;
+
+    /// Number of elements in the run
+    std::int64_t count;
+
+    /// One based partition owning the elements
+    std::int32_t owner;
+
+    /// Sorted one based partitions the elements are ghosts of
+    std::vector<std::int32_t> ghosts;
+
+    /// Sorted one based partitions owning an element that shares a node with
+    /// an element of the run
+    std::vector<std::int32_t> neighbours;
+
+    /// Id of the first element of the run, which is checked after seeking
+    std::int64_t first_id;
+};
+
+/// Offset of the nodes of a FETI interface in the numbering of all interface
+/// nodes, which depends on every interface of the mesh \sa partition_interface
+struct interface_offset
+{
+    /// One based master and slave partitions
+    std::int32_t master, slave;
+
+    std::int64_t global_start_id;
+};
+
+/// Location of the nodes and of the elements of each partition in a mesh file
+struct mesh_index
+{
+    /// Size of the indexed mesh file in bytes
+    std::uint64_t file_size = 0;
+
+    /// Modification time of the indexed mesh file in nanoseconds
+    std::int64_t modified = 0;
+
+    /// Number of partitions in the mesh
+    int partitions = 1;
+
+    /// Physical names of the mesh
+    std::map<std::int32_t, std::string> physical_names;
+
+    /// Lower and upper corners of the box bounding the nodes
+    std::array<double, 3> lower{}, upper{};
+
+    std::vector<node_block> node_blocks;
+
+    std::vector<element_run> element_runs;
+
+    /// Offsets of the FETI interfaces found from the ghost elements
+    std::vector<interface_offset> interfaces;
+
+    /// Total number of interface nodes (FETI format)
+    std::int64_t interface_nodes = 0;
+
+    /// Offsets of the FETI interfaces found from the nodes shared by elements
+    /// of different owners \sa interface_detection
+    std::vector<interface_offset> shared_node_interfaces;
+
+    /// Total number of interface nodes found from the shared nodes
+    std::int64_t shared_interface_nodes = 0;
+};
+
+/// \return name of the index of a mesh file
+std::string index_file_name(std::string const& mesh_file_name);
+
+/// Scan a Gmsh file and record the location of the nodes and elements
+/// \param block_size Maximum number of lines in a node block or element run
+mesh_index build_mesh_index(std::string const& mesh_file_name,
+                            std::int64_t const block_size = 4096);
+
+/// Write the index of a mesh file \sa index_file_name
+void write_mesh_index(mesh_index const& index, std::string const& mesh_file_name);
+
+/// Read the index of a mesh file, building and writing it first if it is
+/// missing or the size or the modification time of the mesh file changed
+mesh_index open_mesh_index(std::string const& mesh_file_name);
+} // namespace imr
@@ -1,12 +1,29 @@
 
 #include "mesh_reader.hpp"
 
+#include "block_compression.hpp"
+#include "container.hpp"
+#include "element_faces.hpp"
+#include "index_transform.hpp"
+#include "mesh_index.hpp"
+#include "queue_streambuf.hpp"
+#include "refinement.hpp"
+
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <exception>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <numeric>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
 
 #include <json/json.h>
 
@@ -24,16 +41,31 @@ mesh_reader::mesh_reader(std::string const& input_file_name,
     fillMesh();
 }
 
+mesh_reader::mesh_reader(std::string const& input_file_name,
+                         int const partition_number,
+                         NodalOrdering const ordering,
+                         IndexingBase const base,
+                         distributed const distributed_option)
+    : input_file_name(input_file_name),
+      useZeroBasedIndexing(base == IndexingBase::Zero),
+      useLocalNodalConnectivity(ordering == NodalOrdering::Local),
+      is_feti_format(distributed_option == distributed::feti),
+      m_extracted_partition(partition_number)
+{
+    extract_partition(partition_number);
+}
+
 void mesh_reader::fillMesh()
 {
     auto const start = std::chrono::high_resolution_clock::now();
 
-    std::fstream gmsh_file(input_file_name);
+    // Read the file in blocks on a separate thread while the blocks are parsed
+    bounded_queue<std::string> blocks(4);
 
-    if (!gmsh_file.is_open())
-    {
-        throw std::domain_error("Input file " + input_file_name + " was not able to be opened");
-    }
+    file_reader reader(input_file_name, blocks);
+
+    queue_streambuf buffer(blocks);
+    std::istream gmsh_file(&buffer);
 
     std::string token, null;
 
@@ -76,11 +108,19 @@ void mesh_reader::fillMesh()
             gmsh_file >> number_of_nodes;
             nodal_data.resize(number_of_nodes);
 
-            for (auto& node : nodal_data)
+            auto& ids         = nodal_data.ids();
+            auto& coordinates = nodal_data.coordinates();
+
+            for (std::int64_t slot = 0; slot < number_of_nodes; ++slot)
             {
-                gmsh_file >> node.id >> node.coordinates[0] >> node.coordinates[1] >>
-                    node.coordinates[2];
+                gmsh_file >> ids[slot] >> coordinates[slot][0] >> coordinates[slot][1] >>
+                    coordinates[slot][2];
             }
+            nodal_data.build_index();
+
+            use_narrow_indices = index_array::fits_narrow(nodal_data.max_id());
+
+            m_bounding_box = nodal_data.bounding_box();
         }
         else if (token == "$Elements")
         {
@@ -89,50 +129,19 @@ void mesh_reader::fillMesh()
 
             for (std::int64_t elementId = 0; elementId < elementIds; elementId++)
             {
-                int id = 0, numberOfTags = 0, elementTypeId = 0;
-
-                gmsh_file >> id >> elementTypeId >> numberOfTags;
-
-                auto const numberOfNodes = mapElementData(elementTypeId);
-
-                std::vector<std::int32_t> tags(numberOfTags, 0);
-                std::vector<std::int64_t> node_indices(numberOfNodes, 0);
-
-                for (auto& tag : tags)
-                {
-                    gmsh_file >> tag;
-                }
-
-                for (auto& node_index : node_indices)
-                {
-                    gmsh_file >> node_index;
-                }
-
-                auto const physicalId = tags[0];
-
-                element elementData(std::move(node_indices), tags, elementTypeId, id);
+                auto elementData = read_element(gmsh_file);
 
                 // Update the total number of partitions on the fly
                 m_partitions = std::max(elementData.maxProcessId(), m_partitions);
 
                 // Copy the element data into the mesh structure
-                meshes[{physicalGroupMap[physicalId], elementTypeId}].push_back(elementData);
-
-                if (elementData.isSharedByMultipleProcesses())
-                {
-                    for (int i = 4; i < tags[2] + 3; ++i)
-                    {
-                        auto const owner_sharer = std::make_pair(tags[3], std::abs(tags[i]));
-
-                        auto const& connectivity = elementData.node_indices();
-
-                        interfaceElementMap[owner_sharer].insert(std::begin(connectivity),
-                                                                 std::end(connectivity));
-                    }
-                }
+                meshes[{physicalGroupMap[elementData.physicalId()], elementData.typeId()}]
+                    .push_back(std::move(elementData));
             }
         }
     }
+    fill_interface_map();
+
     std::cout << std::string(2, ' ') << "A total number of " << m_partitions
               << " partitions were found\n";
 
@@ -142,344 +151,2305 @@ void mesh_reader::fillMesh()
     std::cout << "Mesh data structure filled in " << elapsed_seconds.count() << "s\n";
 }
 
-int mesh_reader::mapElementData(int const elementTypeId)
+element mesh_reader::read_element(std::istream& gmsh_file) const
 {
-    // Return the number of local nodes per element
-    switch (elementTypeId)
+    int id = 0, numberOfTags = 0, elementTypeId = 0;
+
+    gmsh_file >> id >> elementTypeId >> numberOfTags;
+
+    auto const numberOfNodes = mapElementData(elementTypeId);
+
+    std::vector<std::int32_t> tags(numberOfTags, 0);
+    std::vector<std::int64_t> node_indices(numberOfNodes, 0);
+
+    for (auto& tag : tags)
     {
-        case LINE2: return 2; break;
-        case TRIANGLE3: return 3; break;
-        case QUADRILATERAL4: return 4; break;
-        case TETRAHEDRON4: return 4; break;
-        case HEXAHEDRON8: return 8; break;
-        case PRISM6: return 6; break;
-        case PYRAMID5: return 5; break;
-        case LINE3: return 3; break;
-        case TRIANGLE6: return 6; break;
-        case QUADRILATERAL9: return 9; break;
-        case TETRAHEDRON10: return 10; break;
-        case HEXAHEDRON27: return 27; break;
-        case PRISM18: return 18; break;
-        case PYRAMID14: return 14; break;
-        case POINT: return 1; break;
-        case QUADRILATERAL8: return 8; break;
-        case HEXAHEDRON20: return 20; break;
-        case PRISM15: return 15; break;
-        case PYRAMID13: return 13; break;
-        case TRIANGLE9: return 19; break;
-        case TRIANGLE10: return 10; break;
-        case TRIANGLE12: return 12; break;
-        case TRIANGLE15: return 15; break;
-        case TRIANGLE15_IC: return 15; break;
-        case TRIANGLE21: return 21; break;
-        case EDGE4: return 4; break;
-        case EDGE5: return 5; break;
-        case EDGE6: return 6; break;
-        case TETRAHEDRON20: return 20; break;
-        case TETRAHEDRON35: return 35; break;
-        case TETRAHEDRON56: return 56; break;
-        case HEXAHEDRON64: return 64; break;
-        case HEXAHEDRON125: return 125; break;
-        default:
-            throw std::domain_error("The elementTypeId " + std::to_string(elementTypeId) +
-                                    " is not implemented");
+        gmsh_file >> tag;
     }
-    return -1;
+
+    for (auto& node_index : node_indices)
+    {
+        gmsh_file >> node_index;
+    }
+    return element(std::move(node_indices), std::move(tags), elementTypeId, id);
 }
 
-void mesh_reader::checkSupportedGmsh(float const gmshVersion)
+void mesh_reader::extract_partition(int const partition_number)
 {
-    if (gmshVersion < 2.2)
+    auto const start = std::chrono::high_resolution_clock::now();
+
+    auto index = open_mesh_index(input_file_name);
+
+    if (!read_indexed_partition(index, partition_number))
     {
-        throw std::runtime_error("GmshVersion " + std::to_string(gmshVersion) +
-                                 " is not supported");
+        // The mesh changed without changing its size or modification time
+        index = build_mesh_index(input_file_name);
+        write_mesh_index(index, input_file_name);
+
+        if (!read_indexed_partition(index, partition_number))
+        {
+            throw std::domain_error("The index of " + input_file_name +
+                                    " does not match the mesh file");
+        }
     }
+
+    use_narrow_indices = index_array::fits_narrow(nodal_data.max_id());
+
+    fill_interface_map();
+
+    auto const end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> elapsed_seconds = end - start;
+    std::cout << "Partition " << partition_number << " of " << m_partitions
+              << " read through the index in " << elapsed_seconds.count() << "s\n";
 }
 
-void mesh_reader::write(bool const print_indices) const
+namespace
 {
-    for (int partition = 0; partition < m_partitions; ++partition)
+/// Seek to a line of the mesh file recorded in the index
+/// \return true if the line starts at the offset and with the id
+bool seek_line(std::istream& gmsh_file, std::uint64_t const offset, std::int64_t const id)
+{
+    // The offset of a line follows the end of the previous line
+    gmsh_file.clear();
+    gmsh_file.seekg(offset - 1);
+
+    if (gmsh_file.get() != '\n') return false;
+
+    std::int64_t line_id = 0;
+    gmsh_file >> line_id;
+
+    if (!gmsh_file || line_id != id) return false;
+
+    gmsh_file.seekg(offset);
+
+    return true;
+}
+}
+
+bool mesh_reader::read_indexed_partition(mesh_index const& index, int const partition_number)
+{
+    if (partition_number < 0 || partition_number >= index.partitions)
     {
-        Mesh process_mesh;
+        throw std::out_of_range("Partition " + std::to_string(partition_number) +
+                                " does not exist in " + input_file_name);
+    }
 
-        // Find all of the elements which belong to this process
-        for (auto const& mesh : meshes)
+    meshes.clear();
+    nodal_data = node_list();
+    m_interface_offsets.clear();
+    m_shared_node_offsets.clear();
+
+    m_partitions     = index.partitions;
+    physicalGroupMap = index.physical_names;
+    m_bounding_box   = {index.lower, index.upper};
+
+    for (auto const& interface : index.interfaces)
+    {
+        m_interface_offsets[{interface.master, interface.slave}] = interface.global_start_id;
+    }
+    m_interface_node_total = index.interface_nodes;
+
+    for (auto const& interface : index.shared_node_interfaces)
+    {
+        m_shared_node_offsets[{interface.master, interface.slave}] = interface.global_start_id;
+    }
+    m_shared_interface_node_total = index.shared_interface_nodes;
+
+    m_mesh_has_ghosts = std::any_of(begin(index.element_runs),
+                                    end(index.element_runs),
+                                    [](auto const& run) { return !run.ghosts.empty(); });
+
+    std::ifstream gmsh_file(input_file_name, std::ios::binary);
+
+    auto const process_id = partition_number + 1;
+
+    // Read the elements owned by the partition
+    for (auto const& run : index.element_runs)
+    {
+        if (run.owner != process_id) continue;
+
+        if (!seek_line(gmsh_file, run.offset, run.first_id)) return false;
+
+        for (std::int64_t i = 0; i < run.count; ++i)
         {
-            // Copy the elements into the process mesh
-            for (auto const& element : mesh.second)
-            {
-                if (element.isOwnedByProcess(partition + 1))
-                {
-                    process_mesh[mesh.first].push_back(element);
-                }
-            }
-        }
+            auto elementData = read_element(gmsh_file);
 
-        auto local_global_mapping = fillLocalToGlobalMap(process_mesh);
+            meshes[{physicalGroupMap[elementData.physicalId()], elementData.typeId()}].push_back(
+                std::move(elementData));
+        }
+    }
 
-        auto local_nodes = fillLocalNodeList(local_global_mapping);
+    std::vector<std::int64_t> owned_node_ids;
+    for (auto const& mesh : meshes)
+    {
+        for (auto const& element : mesh.second)
+        {
+            owned_node_ids.insert(end(owned_node_ids),
+                                  begin(element.node_indices()),
+                                  end(element.node_indices()));
+        }
+    }
+    std::sort(begin(owned_node_ids), end(owned_node_ids));
 
-        if (useLocalNodalConnectivity)
+    // Read the ghost elements of the neighbours and the elements of the
+    // neighbours sharing a node with the partition, which are needed for the
+    // interfaces found from the ghost elements and from the shared nodes
+    for (auto const& run : index.element_runs)
+    {
+        if (run.owner == process_id ||
+            (!std::binary_search(begin(run.ghosts), end(run.ghosts), process_id) &&
+             !std::binary_search(begin(run.neighbours), end(run.neighbours), process_id)))
         {
-            reorderLocalMesh(process_mesh, local_global_mapping);
+            continue;
         }
 
-        // Check if this local mesh needs to be converted to zero based indexing
-        // then correct the nodal connectivities, the mappings and the nodal and
-        // element ids of the data structures
-        if (useZeroBasedIndexing)
+        if (!seek_line(gmsh_file, run.offset, run.first_id)) return false;
+
+        for (std::int64_t i = 0; i < run.count; ++i)
         {
-            std::transform(begin(local_global_mapping),
-                           end(local_global_mapping),
-                           begin(local_global_mapping),
-                           [](auto const value) { return value - 1; });
+            auto elementData = read_element(gmsh_file);
 
-            for (auto& localNode : local_nodes)
-            {
-                --localNode.id;
-            }
+            auto const& tags = elementData.partitionTags();
+            auto const& nodes = elementData.node_indices();
 
-            for (auto& mesh : process_mesh)
+            if ((tags.size() > 2 &&
+                 std::find(begin(tags) + 2, end(tags), -process_id) != end(tags)) ||
+                std::any_of(begin(nodes), end(nodes), [&](auto const node) {
+                    return std::binary_search(begin(owned_node_ids), end(owned_node_ids), node);
+                }))
             {
-                for (auto& element : mesh.second)
-                {
-                    element.convertToZeroBasedIndexing();
-                }
+                meshes[{physicalGroupMap[elementData.physicalId()], elementData.typeId()}]
+                    .push_back(std::move(elementData));
             }
         }
-
-        write_json(process_mesh,
-                   local_global_mapping,
-                   local_nodes,
-                   partition,
-                   m_partitions > 1,
-                   print_indices);
-
-        std::cout << std::string(2, ' ') << "Finished writing out JSON file for mesh partition "
-                  << partition << "\n";
     }
-}
 
-std::vector<std::int64_t> mesh_reader::fillLocalToGlobalMap(Mesh const& process_mesh) const
-{
-    std::vector<std::int64_t> local_global_mapping;
-
-    for (auto const& mesh : process_mesh)
+    // Read the blocks of nodes containing a node of the elements
+    std::vector<std::int64_t> node_ids;
+    for (auto const& mesh : meshes)
     {
         for (auto const& element : mesh.second)
         {
-            auto const& nodes = element.node_indices();
-            std::copy(std::begin(nodes), std::end(nodes), std::back_inserter(local_global_mapping));
+            node_ids.insert(end(node_ids),
+                            begin(element.node_indices()),
+                            end(element.node_indices()));
         }
     }
+    std::sort(begin(node_ids), end(node_ids));
+    node_ids.erase(std::unique(begin(node_ids), end(node_ids)), end(node_ids));
 
-    // Sort and remove duplicates
-    std::sort(std::begin(local_global_mapping), std::end(local_global_mapping));
-
-    local_global_mapping.erase(std::unique(std::begin(local_global_mapping),
-                                           std::end(local_global_mapping)),
-                               std::end(local_global_mapping));
-    return local_global_mapping;
-}
+    nodal_data.reserve(node_ids.size());
 
-void mesh_reader::reorderLocalMesh(Mesh& process_mesh,
-                                   std::vector<std::int64_t> const& local_global_mapping) const
-{
-    for (auto& mesh : process_mesh)
+    for (auto const& block : index.node_blocks)
     {
-        for (auto& element : mesh.second)
+        auto const first = std::lower_bound(begin(node_ids), end(node_ids), block.min_id);
+
+        if (first == end(node_ids) || *first > block.max_id) continue;
+
+        if (!seek_line(gmsh_file, block.offset, block.first_id)) return false;
+
+        for (std::int64_t i = 0; i < block.count; ++i)
         {
-            for (auto& node : element.node_indices())
-            {
-                auto const found = std::lower_bound(std::begin(local_global_mapping),
-                                                    std::end(local_global_mapping),
-                                                    node);
+            std::int64_t id;
+            node_list::coordinate_type coordinates;
+
+            gmsh_file >> id >> coordinates[0] >> coordinates[1] >> coordinates[2];
 
-                // Reset the node value to that inside the local ordering with
-                // the default of one based ordering
-                node = std::distance(local_global_mapping.begin(), found) + 1;
+            if (!gmsh_file) return false;
+
+            if (std::binary_search(begin(node_ids), end(node_ids), id))
+            {
+                nodal_data.push_back(id, coordinates);
             }
         }
     }
+
+    if (nodal_data.size() != node_ids.size())
+    {
+        throw std::domain_error("An element in " + input_file_name +
+                                " references a node that does not exist");
+    }
+    nodal_data.build_index();
+
+    return true;
 }
 
-std::vector<node>
-mesh_reader::fillLocalNodeList(std::vector<std::int64_t> const& local_global_mapping) const
+void mesh_reader::add_interface_element(element const& shared_element)
 {
-    std::vector<node> local_nodal_data;
-    local_nodal_data.reserve(local_global_mapping.size());
+    // The partition tags hold the number of partitions, the owner and then
+    // the sharing partitions
+    auto const& tags = shared_element.partitionTags();
 
-    for (auto const& node_index : local_global_mapping)
+    for (int i = 2; i < tags[0] + 1; ++i)
     {
-        local_nodal_data.emplace_back(nodal_data[node_index - 1]);
+        auto const owner_sharer = std::make_pair(tags[1], std::abs(tags[i]));
+
+        auto const& connectivity = shared_element.node_indices();
+
+        interfaceElementMap[owner_sharer].insert(std::begin(connectivity), std::end(connectivity));
     }
-    return local_nodal_data;
 }
 
-void mesh_reader::write_json(Mesh const& process_mesh,
-                             std::vector<std::int64_t> const& localToGlobalMapping,
-                             std::vector<node> const& nodalCoordinates,
-                             int const partition_number,
-                             bool const is_decomposed,
-                             bool const print_indices) const
+void mesh_reader::fill_interface_map()
 {
-    // Write out each file to Json format
-    Json::Value event;
+    interfaceElementMap.clear();
 
-    std::string output_file_name = input_file_name.substr(0, input_file_name.find_last_of('.')) +
-                                   ".mesh";
-
-    if (is_decomposed)
+    if (m_interface_detection == interface_detection::ghost_tags)
     {
-        output_file_name += std::to_string(partition_number);
+        for (auto const& mesh : meshes)
+        {
+            for (auto const& element : mesh.second)
+            {
+                if (element.isSharedByMultipleProcesses()) add_interface_element(element);
+            }
+        }
     }
 
-    std::fstream writer;
-    writer.open(output_file_name, std::ios::out);
+    // Meshes partitioned without ghost elements have no interfaces from the
+    // tags, where an extracted partition relies on the index for the mesh
+    auto const has_ghosts = m_extracted_partition < 0 ? !interfaceElementMap.empty()
+                                                      : m_mesh_has_ghosts;
 
-    // Write out the nodal coordinates
-    Json::Value nodeGroup;
-    auto& nodeGroupCoordinates = nodeGroup["Coordinates"];
+    if (!(m_interface_detection == interface_detection::ghost_tags && has_ghosts) &&
+        m_partitions > 1)
+    {
+        fill_shared_node_interfaces();
+    }
 
-    for (auto const& node : nodalCoordinates)
+    // Only the interfaces of an extracted partition are complete
+    if (m_extracted_partition >= 0)
     {
-        Json::Value coordinates(Json::arrayValue);
-        for (auto const& xyz : node.coordinates)
+        auto const process_id = m_extracted_partition + 1;
+
+        for (auto i = begin(interfaceElementMap); i != end(interfaceElementMap);)
         {
-            coordinates.append(Json::Value(xyz));
+            if (i->first.first == process_id || i->first.second == process_id)
+            {
+                ++i;
+            }
+            else
+            {
+                i = interfaceElementMap.erase(i);
+            }
         }
-        nodeGroupCoordinates.append(coordinates);
+    }
+}
 
-        if (print_indices)
+void mesh_reader::fill_shared_node_interfaces()
+{
+    // Element to node graph over the partitioned elements using node slots
+    std::vector<element const*> elements;
+    csr_graph element_nodes;
+
+    for (auto const& mesh : meshes)
+    {
+        for (auto const& element : mesh.second)
         {
-            nodeGroup["Indices"].append(node.id);
+            if (element.partitionTags().empty()) continue;
+
+            elements.push_back(&element);
+
+            for (auto const node_index : element.node_indices())
+            {
+                element_nodes.indices.push_back(nodal_data.slot(node_index));
+            }
+            element_nodes.offsets.push_back(element_nodes.indices.size());
         }
     }
-    event["Nodes"].append(nodeGroup);
 
-    for (auto const& mesh : process_mesh)
+    if (std::find(begin(element_nodes.indices), end(element_nodes.indices), -1) !=
+        end(element_nodes.indices))
+    {
+        throw std::domain_error("An element in " + input_file_name +
+                                " references a node that does not exist");
+    }
+
+    // Bucket the (node, owner) pairs by node with a parallel counting sort
+    auto const node_elements = transpose(element_nodes, nodal_data.size());
+
+    // Pairs of owning partitions and the node they share
+    using shared_node = std::tuple<std::int32_t, std::int32_t, std::int64_t>;
+
+    std::vector<shared_node> shared_nodes;
+
+#pragma omp parallel
     {
-        Json::Value elementGroup;
-        auto& elementGroupNodalConnectivity = elementGroup["NodalConnectivity"];
+        std::vector<shared_node> local_shared_nodes;
+        std::vector<std::int32_t> owners;
 
-        for (auto const& element_data : mesh.second)
+#pragma omp for nowait
+        for (std::int64_t slot = 0; slot < static_cast<std::int64_t>(nodal_data.size()); ++slot)
         {
-            Json::Value connectivity(Json::arrayValue);
+            owners.clear();
 
-            for (auto const& node : element_data.node_indices())
+            for (auto const element : node_elements.row(slot))
             {
-                connectivity.append(node);
+                owners.push_back(elements[element]->owner_process());
             }
+            std::sort(begin(owners), end(owners));
+            owners.erase(std::unique(begin(owners), end(owners)), end(owners));
 
-            elementGroupNodalConnectivity.append(connectivity);
+            if (owners.size() < 2) continue;
 
-            if (print_indices) elementGroup["Indices"].append(element_data.id());
+            for (auto const owner : owners)
+            {
+                for (auto const sharer : owners)
+                {
+                    if (owner != sharer)
+                    {
+                        local_shared_nodes.emplace_back(owner, sharer, nodal_data.ids()[slot]);
+                    }
+                }
+            }
         }
 
-        elementGroup["Name"] = mesh.first.first;
-        elementGroup["Type"] = mesh.first.second;
-
-        event["Elements"].append(elementGroup);
+#pragma omp critical
+        shared_nodes.insert(end(shared_nodes),
+                            begin(local_shared_nodes),
+                            end(local_shared_nodes));
     }
 
-    if (is_decomposed)
+    // Sorting by partitions and then nodes appends each node to the end of its set
+    std::sort(begin(shared_nodes), end(shared_nodes));
+
+    for (auto const& shared : shared_nodes)
     {
-        auto& eventLocalToGlobalMap = event["LocalToGlobalMap"];
-        for (auto const& l2g : localToGlobalMapping)
-        {
-            eventLocalToGlobalMap.append(l2g);
-        }
+        auto& nodes = interfaceElementMap[{std::get<0>(shared), std::get<1>(shared)}];
+        nodes.insert(end(nodes), std::get<2>(shared));
+    }
+}
 
-        if (is_feti_format)
-        {
-            long globalStartId{0l};
+void mesh_reader::set_interface_detection(interface_detection const detection)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
 
-            for (auto const& interface : interfaceElementMap)
-            {
-                auto const master_partition = interface.first.first;
-                auto const slave_partition  = interface.first.second;
+    if (detection == m_interface_detection) return;
 
-                if (master_partition < slave_partition)
-                {
-                    std::set<std::int64_t> intersection;
+    m_interface_detection = detection;
 
-                    auto const& v1 = interface.second;
-                    auto const& v2 = interfaceElementMap.at({slave_partition, master_partition});
+    fill_interface_map();
 
-                    std::set_intersection(std::begin(v1),
-                                          std::end(v1),
-                                          std::begin(v2),
-                                          std::end(v2),
-                                          std::inserter(intersection, std::begin(intersection)));
+    partition_cache.clear();
+}
 
-                    if (partition_number == master_partition - 1 or
-                        partition_number == slave_partition - 1)
-                    {
-                        Json::Value interface_group, nodal_numbers;
+void mesh_reader::refine(int const levels)
+{
+    if (levels <= 0) return;
+
+    if (m_extracted_partition >= 0)
+    {
+        throw std::domain_error("Refinement requires the complete mesh of " + input_file_name);
+    }
 
-                        for (auto const& node_number : intersection)
-                            nodal_numbers.append(node_number);
+    std::lock_guard<std::mutex> lock(cache_mutex);
 
-                        interface_group["NodeIds"].append(nodal_numbers);
+    for (int level = 0; level < levels; ++level)
+    {
+        refine_once();
+    }
 
-                        interface_group["Master"] = useZeroBasedIndexing ? master_partition - 1
-                                                                         : master_partition;
+    mesh_changed();
+}
 
-                        interface_group["Slave"] = useZeroBasedIndexing ? slave_partition - 1
-                                                                        : slave_partition;
+void mesh_reader::mesh_changed()
+{
+    fill_interface_map();
 
-                        interface_group["Value"] = partition_number == master_partition - 1 ? 1
-                                                                                            : -1;
+    use_narrow_indices = index_array::fits_narrow(nodal_data.max_id());
 
-                        interface_group["GlobalStartId"] = globalStartId;
+    m_bounding_box = nodal_data.bounding_box();
 
-                        event["Interface"].append(interface_group);
-                    }
-                    globalStartId += intersection.size();
-                }
-            }
-            event["NumInterfaceNodes"] = globalStartId;
-        }
-        else
+    partition_cache.clear();
+    m_adjacency.reset();
+    m_skin.reset();
+}
+
+void mesh_reader::refine_once()
+{
+    std::vector<element const*> elements;
+    std::vector<refinement_template const*> refinements;
+
+    for (auto const& mesh : meshes)
+    {
+        auto const& refinement = element_refinement(mesh.first.second);
+
+        for (auto const& element : mesh.second)
         {
-            for (auto const& interface : interfaceElementMap)
-            {
-                auto const master_partition = interface.first.first;
-                auto const slave_partition  = interface.first.second;
+            elements.push_back(&element);
+            refinements.push_back(&refinement);
+        }
+    }
 
-                if (partition_number == slave_partition - 1)
-                {
-                    std::set<std::int64_t> intersection;
+    auto const size = static_cast<std::int64_t>(elements.size());
 
-                    // Find the common indices between the master and the slave
-                    // partition and print these out for each process interface
-                    auto const& v1 = interface.second;
-                    auto const& v2 = interfaceElementMap.at({slave_partition, master_partition});
+    std::vector<std::int64_t> node_offsets(size + 1, 0);
+    for (std::int64_t element = 0; element < size; ++element)
+    {
+        node_offsets[element + 1] = node_offsets[element] + refinements[element]->new_nodes.size();
+    }
 
-                    std::set_intersection(std::begin(v1),
-                                          std::end(v1),
-                                          std::begin(v2),
-                                          std::end(v2),
-                                          std::inserter(intersection, std::begin(intersection)));
+    // A new node is identified by the sorted ids of the parent nodes it is
+    // centred on, so the elements sharing an edge or a face share its node
+    using node_key = std::array<std::int64_t, 8>;
 
-                    Json::Value interface_group, nodal_numbers;
+    std::vector<node_key> keys(node_offsets.back());
 
-                    for (auto const& node_number : intersection)
-                    {
-                        nodal_numbers.append(useZeroBasedIndexing ? node_number - 1 : node_number);
-                    }
-                    interface_group["Indices"] = nodal_numbers;
+    // Bucket the keys by hash so the matching keys meet in the same bucket
+    auto const buckets = std::max(std::int64_t(1), static_cast<std::int64_t>(keys.size() / 8));
 
-                    interface_group["Process"] = useZeroBasedIndexing ? master_partition - 1
-                                                                      : master_partition;
+    csr_graph key_buckets;
+    key_buckets.offsets.resize(keys.size() + 1);
+    key_buckets.indices.resize(keys.size());
+    std::iota(begin(key_buckets.offsets), end(key_buckets.offsets), 0);
 
-                    event["Interface"].append(interface_group);
-                }
+#pragma omp parallel for
+    for (std::int64_t element = 0; element < size; ++element)
+    {
+        auto const& nodes = elements[element]->node_indices();
+
+        auto position = node_offsets[element];
+
+        for (auto const& parents : refinements[element]->new_nodes)
+        {
+            auto& key = keys[position];
+
+            key.fill(-1);
+            std::transform(begin(parents), end(parents), begin(key), [&nodes](auto const node) {
+                return nodes[node];
+            });
+            std::sort(begin(key), begin(key) + parents.size());
+
+            std::uint64_t hash = 0;
+            for (auto const node : key)
+            {
+                hash = hash * 1000003 ^ static_cast<std::uint64_t>(node);
+            }
+            key_buckets.indices[position] = hash % buckets;
+
+            ++position;
+        }
+    }
+
+    auto bucket_keys = transpose(key_buckets, buckets);
+
+    // Sort the keys of each bucket and count the distinct keys
+    std::vector<std::int64_t> bucket_nodes(buckets + 1, 0);
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (std::int64_t bucket = 0; bucket < buckets; ++bucket)
+    {
+        auto const first = begin(bucket_keys.indices) + bucket_keys.offsets[bucket];
+        auto const last  = begin(bucket_keys.indices) + bucket_keys.offsets[bucket + 1];
+
+        std::sort(first, last, [&keys](auto const left, auto const right) {
+            return std::tie(keys[left], left) < std::tie(keys[right], right);
+        });
+
+        for (auto key = first; key != last; ++key)
+        {
+            if (key == first || keys[*key] != keys[*(key - 1)]) ++bucket_nodes[bucket + 1];
+        }
+    }
+
+    std::partial_sum(begin(bucket_nodes), end(bucket_nodes), begin(bucket_nodes));
+
+    // Number the new nodes after the existing nodes in the order of the buckets
+    auto const first_id = nodal_data.max_id() + 1;
+
+    std::vector<std::int64_t> new_ids(keys.size());
+    std::vector<node_list::coordinate_type> coordinates(bucket_nodes.back());
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (std::int64_t bucket = 0; bucket < buckets; ++bucket)
+    {
+        auto const first = begin(bucket_keys.indices) + bucket_keys.offsets[bucket];
+        auto const last  = begin(bucket_keys.indices) + bucket_keys.offsets[bucket + 1];
+
+        auto node = bucket_nodes[bucket] - 1;
+
+        for (auto key = first; key != last; ++key)
+        {
+            if (key == first || keys[*key] != keys[*(key - 1)])
+            {
+                ++node;
+
+                // The unused entries of the key are at the end
+                auto const& parent_ids = keys[*key];
+
+                auto const parents = std::find(begin(parent_ids), end(parent_ids), -1) -
+                                     begin(parent_ids);
+
+                coordinates[node].fill(0.0);
+                for (std::int64_t parent = 0; parent < parents; ++parent)
+                {
+                    auto const& xyz = nodal_data.coordinates()[nodal_data.slot(parent_ids[parent])];
+
+                    for (int i = 0; i < 3; ++i) coordinates[node][i] += xyz[i] / parents;
+                }
+            }
+            new_ids[*key] = first_id + node;
+        }
+    }
+
+    auto const first_slot = nodal_data.size();
+
+    nodal_data.resize(first_slot + coordinates.size());
+
+    std::iota(begin(nodal_data.ids()) + first_slot, end(nodal_data.ids()), first_id);
+    std::copy(begin(coordinates), end(coordinates), begin(nodal_data.coordinates()) + first_slot);
+
+    nodal_data.build_index();
+
+    // Replace each element by its children, numbering the elements from one
+    int id = 1;
+    std::int64_t parent_index = 0;
+
+    for (auto& mesh : meshes)
+    {
+        auto const& refinement = element_refinement(mesh.first.second);
+
+        std::vector<element> children;
+        children.reserve(mesh.second.size() * refinement.children.size());
+
+        for (auto const& parent : mesh.second)
+        {
+            auto local_nodes = parent.node_indices();
+            local_nodes.insert(end(local_nodes),
+                               begin(new_ids) + node_offsets[parent_index],
+                               begin(new_ids) + node_offsets[parent_index + 1]);
+
+            std::vector<std::int32_t> tags{parent.physicalId(), parent.geometricId()};
+            tags.insert(end(tags), begin(parent.partitionTags()), end(parent.partitionTags()));
+
+            for (auto const& child : refinement.children)
+            {
+                std::vector<std::int64_t> child_nodes(child.size());
+                std::transform(begin(child), end(child), begin(child_nodes), [&](auto const node) {
+                    return local_nodes[node];
+                });
+                children.emplace_back(std::move(child_nodes), tags, mesh.first.second, id++);
+            }
+            ++parent_index;
+        }
+        mesh.second = std::move(children);
+    }
+}
+
+std::int64_t mesh_reader::merge_nodes(double const relative_tolerance)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    auto const size = static_cast<std::int64_t>(nodal_data.size());
+
+    if (relative_tolerance <= 0.0 || size < 2) return 0;
+
+    if (m_extracted_partition >= 0)
+    {
+        throw std::domain_error("Merging nodes requires the complete mesh of " + input_file_name);
+    }
+
+    auto const& coordinates = nodal_data.coordinates();
+    auto const& ids         = nodal_data.ids();
+
+    auto const lower = m_bounding_box.first;
+    auto const upper = m_bounding_box.second;
+
+    auto const diagonal = std::sqrt(std::pow(upper[0] - lower[0], 2) +
+                                    std::pow(upper[1] - lower[1], 2) +
+                                    std::pow(upper[2] - lower[2], 2));
+
+    auto const tolerance = relative_tolerance * diagonal;
+
+    if (tolerance <= 0.0) return 0;
+
+    // Nodes closer than the tolerance are in the same or a neighbouring cell
+    // of a uniform grid with cells larger than the tolerance.  Larger cells
+    // mean fewer nodes are close enough to a cell face to search the neighbour.
+    using grid_cell = std::array<std::int64_t, 3>;
+
+    auto const cell_size = std::max(8.0 * tolerance, diagonal / 1.0e15);
+
+    auto const cell_of = [&](node_list::coordinate_type const& xyz) {
+        return grid_cell{{static_cast<std::int64_t>((xyz[0] - lower[0]) / cell_size),
+                          static_cast<std::int64_t>((xyz[1] - lower[1]) / cell_size),
+                          static_cast<std::int64_t>((xyz[2] - lower[2]) / cell_size)}};
+    };
+
+    auto const buckets = std::max(std::int64_t(1), size / 4);
+
+    auto const bucket_of = [buckets](grid_cell const& cell) {
+        std::uint64_t hash = 0;
+        for (auto const index : cell)
+        {
+            hash = hash * 1000003 ^ static_cast<std::uint64_t>(index);
+        }
+        return static_cast<std::int64_t>(hash % buckets);
+    };
+
+    std::vector<grid_cell> cells(size);
+
+    csr_graph node_buckets;
+    node_buckets.offsets.resize(size + 1);
+    node_buckets.indices.resize(size);
+    std::iota(begin(node_buckets.offsets), end(node_buckets.offsets), 0);
+
+#pragma omp parallel for
+    for (std::int64_t slot = 0; slot < size; ++slot)
+    {
+        cells[slot]                = cell_of(coordinates[slot]);
+        node_buckets.indices[slot] = bucket_of(cells[slot]);
+    }
+
+    // Order the nodes of each bucket by cell so a cell is a contiguous range
+    auto bucket_nodes = transpose(node_buckets, buckets);
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (std::int64_t bucket = 0; bucket < buckets; ++bucket)
+    {
+        std::sort(begin(bucket_nodes.indices) + bucket_nodes.offsets[bucket],
+                  begin(bucket_nodes.indices) + bucket_nodes.offsets[bucket + 1],
+                  [&cells](auto const left, auto const right) {
+                      return std::tie(cells[left], left) < std::tie(cells[right], right);
+                  });
+    }
+
+    auto const squared_distance = [&coordinates](auto const left, auto const right) {
+        auto const dx = coordinates[left][0] - coordinates[right][0];
+        auto const dy = coordinates[left][1] - coordinates[right][1];
+        auto const dz = coordinates[left][2] - coordinates[right][2];
+
+        return dx * dx + dy * dy + dz * dz;
+    };
+
+    // Each node is merged into the node with the lowest id within the tolerance
+    std::vector<std::int64_t> target(size);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::int64_t slot = 0; slot < size; ++slot)
+    {
+        target[slot] = slot;
+
+        auto const& cell = cells[slot];
+
+        // Only search the neighbouring cells within the tolerance of the node
+        grid_cell first_offset, last_offset;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            auto const position = coordinates[slot][i] - lower[i] - cell[i] * cell_size;
+
+            first_offset[i] = position < tolerance ? -1 : 0;
+            last_offset[i]  = cell_size - position <= tolerance ? 1 : 0;
+        }
+
+        for (auto dx = first_offset[0]; dx <= last_offset[0]; ++dx)
+        {
+            for (auto dy = first_offset[1]; dy <= last_offset[1]; ++dy)
+            {
+                for (auto dz = first_offset[2]; dz <= last_offset[2]; ++dz)
+                {
+                    grid_cell const neighbour{{cell[0] + dx, cell[1] + dy, cell[2] + dz}};
+
+                    auto const bucket = bucket_of(neighbour);
+
+                    auto const first = begin(bucket_nodes.indices) + bucket_nodes.offsets[bucket];
+                    auto const last  = begin(bucket_nodes.indices) +
+                                      bucket_nodes.offsets[bucket + 1];
+
+                    auto candidate = std::lower_bound(first,
+                                                      last,
+                                                      neighbour,
+                                                      [&cells](auto const other, auto const& key) {
+                                                          return cells[other] < key;
+                                                      });
+
+                    for (; candidate != last && cells[*candidate] == neighbour; ++candidate)
+                    {
+                        auto const other = *candidate;
+
+                        if (ids[other] >= ids[target[slot]]) continue;
+
+                        if (squared_distance(other, slot) <= tolerance * tolerance)
+                        {
+                            target[slot] = other;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Follow the chains of merged nodes, where each step lowers the id
+    std::vector<std::int64_t> merged(size);
+
+#pragma omp parallel for
+    for (std::int64_t slot = 0; slot < size; ++slot)
+    {
+        auto root = slot;
+        while (target[root] != root) root = target[root];
+
+        merged[slot] = root;
+    }
+
+    std::int64_t removed = 0;
+    for (std::int64_t slot = 0; slot < size; ++slot)
+    {
+        if (merged[slot] != slot) ++removed;
+    }
+
+    if (removed == 0) return 0;
+
+    // Replace the merged nodes in the connectivity of every element
+    for (auto& mesh : meshes)
+    {
+        auto& elements = mesh.second;
+
+#pragma omp parallel for
+        for (std::int64_t element = 0; element < static_cast<std::int64_t>(elements.size());
+             ++element)
+        {
+            for (auto& node_id : elements[element].node_indices())
+            {
+                auto const slot = nodal_data.slot(node_id);
+
+                if (slot >= 0) node_id = ids[merged[slot]];
+            }
+        }
+    }
+
+    node_list nodes;
+    nodes.reserve(size - removed);
+
+    for (std::int64_t slot = 0; slot < size; ++slot)
+    {
+        if (merged[slot] == slot) nodes.push_back(ids[slot], coordinates[slot]);
+    }
+    nodes.build_index();
+
+    nodal_data = std::move(nodes);
+
+    mesh_changed();
+
+    return removed;
+}
+
+int mesh_reader::mapElementData(int const elementTypeId) const
+{
+    // Return the number of local nodes per element
+    switch (elementTypeId)
+    {
+        case LINE2: return 2; break;
+        case TRIANGLE3: return 3; break;
+        case QUADRILATERAL4: return 4; break;
+        case TETRAHEDRON4: return 4; break;
+        case HEXAHEDRON8: return 8; break;
+        case PRISM6: return 6; break;
+        case PYRAMID5: return 5; break;
+        case LINE3: return 3; break;
+        case TRIANGLE6: return 6; break;
+        case QUADRILATERAL9: return 9; break;
+        case TETRAHEDRON10: return 10; break;
+        case HEXAHEDRON27: return 27; break;
+        case PRISM18: return 18; break;
+        case PYRAMID14: return 14; break;
+        case POINT: return 1; break;
+        case QUADRILATERAL8: return 8; break;
+        case HEXAHEDRON20: return 20; break;
+        case PRISM15: return 15; break;
+        case PYRAMID13: return 13; break;
+        case TRIANGLE9: return 19; break;
+        case TRIANGLE10: return 10; break;
+        case TRIANGLE12: return 12; break;
+        case TRIANGLE15: return 15; break;
+        case TRIANGLE15_IC: return 15; break;
+        case TRIANGLE21: return 21; break;
+        case EDGE4: return 4; break;
+        case EDGE5: return 5; break;
+        case EDGE6: return 6; break;
+        case TETRAHEDRON20: return 20; break;
+        case TETRAHEDRON35: return 35; break;
+        case TETRAHEDRON56: return 56; break;
+        case HEXAHEDRON64: return 64; break;
+        case HEXAHEDRON125: return 125; break;
+        default:
+            throw std::domain_error("The elementTypeId " + std::to_string(elementTypeId) +
+                                    " is not implemented");
+    }
+    return -1;
+}
+
+void mesh_reader::checkSupportedGmsh(float const gmshVersion)
+{
+    if (gmshVersion < 2.2)
+    {
+        throw std::runtime_error("GmshVersion " + std::to_string(gmshVersion) +
+                                 " is not supported");
+    }
+}
+
+namespace
+{
+void write_file(std::string const& file_name, std::string const& contents)
+{
+    std::fstream writer(file_name, std::ios::out | std::ios::binary);
+    writer << contents;
+
+    if (!writer)
+    {
+        throw std::domain_error("Output file " + file_name + " was not able to be written");
+    }
+}
+
+/// Conversion of the nodal coordinates to the precision of the output files
+/// \sa output_options::precision
+class coordinate_encoding
+{
+public:
+    using bounding_box = std::pair<node_list::coordinate_type, node_list::coordinate_type>;
+
+public:
+    coordinate_encoding(output_options const& options, bounding_box const& box)
+        : precision(options.precision), bits(options.quantisation_bits), origin(box.first)
+    {
+        if (precision != coordinate_precision::quantised) return;
+
+        if (bits < 1 || bits > 52)
+        {
+            throw std::domain_error("The number of quantisation bits " + std::to_string(bits) +
+                                    " is not between 1 and 52");
+        }
+
+        auto const extent = std::max({box.second[0] - box.first[0],
+                                      box.second[1] - box.first[1],
+                                      box.second[2] - box.first[2]});
+
+        // The same spacing in every direction preserves the shape of the elements
+        scale = extent > 0.0 ? extent / static_cast<double>((std::int64_t(1) << bits) - 1) : 1.0;
+    }
+
+    /// \return coordinate of an axis in the output precision
+    Json::Value operator()(double const coordinate, int const axis) const
+    {
+        switch (precision)
+        {
+            case coordinate_precision::float32:
+                return Json::Value(static_cast<double>(static_cast<float>(coordinate)));
+            case coordinate_precision::quantised:
+                return Json::Int64(std::llround((coordinate - origin[axis]) / scale));
+            case coordinate_precision::float64: break;
+        }
+        return Json::Value(coordinate);
+    }
+
+    /// \return description of the precision to decode the coordinates
+    Json::Value header() const
+    {
+        Json::Value description;
+
+        if (precision == coordinate_precision::float32)
+        {
+            description["Type"] = "float32";
+        }
+        else if (precision == coordinate_precision::quantised)
+        {
+            description["Type"] = "quantised";
+            description["Bits"] = bits;
+            for (auto const xyz : origin) description["Origin"].append(xyz);
+            description["Scale"]      = scale;
+            description["ErrorBound"] = scale / 2.0;
+        }
+        return description;
+    }
+
+private:
+    coordinate_precision precision;
+    int bits;
+    node_list::coordinate_type origin;
+    double scale = 1.0;
+};
+
+/// \return JSON representation of the coordinates (and ids) of the nodes
+Json::Value write_json_nodes(node_list const& nodes,
+                             bool const print_indices,
+                             coordinate_encoding const& encode)
+{
+    Json::Value nodeGroup;
+    auto& nodeGroupCoordinates = nodeGroup["Coordinates"];
+
+    for (std::size_t slot = 0; slot < nodes.size(); ++slot)
+    {
+        Json::Value coordinates(Json::arrayValue);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            coordinates.append(encode(nodes.coordinates()[slot][axis], axis));
+        }
+        nodeGroupCoordinates.append(coordinates);
+
+        if (print_indices)
+        {
+            nodeGroup["Indices"].append(Json::Int64(nodes.ids()[slot]));
+        }
+    }
+    return nodeGroup;
+}
+
+/// \return JSON representation of the connectivity (and ids) of an element group
+Json::Value write_json_elements(element_group const& group, bool const print_indices)
+{
+    Json::Value elementGroup;
+    auto& elementGroupNodalConnectivity = elementGroup["NodalConnectivity"];
+
+    for (std::size_t element = 0; element < group.size(); ++element)
+    {
+        Json::Value connectivity(Json::arrayValue);
+
+        auto const first = element * group.nodes_per_element;
+
+        for (auto node = first; node < first + group.nodes_per_element; ++node)
+        {
+            connectivity.append(Json::Int64(group.node_indices[node]));
+        }
+
+        elementGroupNodalConnectivity.append(connectivity);
+
+        if (print_indices) elementGroup["Indices"].append(group.ids[element]);
+    }
+
+    elementGroup["Name"] = group.name;
+    elementGroup["Type"] = group.type_id;
+
+    for (auto const offset : group.colour_offsets)
+    {
+        elementGroup["ColourOffsets"].append(Json::Int64(offset));
+    }
+
+    return elementGroup;
+}
+
+/// \return JSON representation of the offsets and indices of a graph
+Json::Value write_json_graph(csr_graph const& graph)
+{
+    Json::Value json_graph;
+
+    // The graphs use zero based local numbers for any ordering and indexing
+    // base of the connectivity, which is recorded for the reader of the file
+    json_graph["Ordering"]  = "Local";
+    json_graph["IndexBase"] = 0;
+
+    auto& offsets = json_graph["Offsets"];
+    for (auto const offset : graph.offsets)
+    {
+        offsets.append(Json::Int64(offset));
+    }
+
+    auto& indices = json_graph["Indices"];
+    indices       = Json::Value(Json::arrayValue);
+    for (auto const index : graph.indices)
+    {
+        indices.append(Json::Int64(index));
+    }
+    return json_graph;
+}
+
+/// Renumber the connectivity of each group into the local ordering given by
+/// the sorted local to global mapping with the offset applied to the result
+template <typename index_type>
+void renumber_local(std::vector<element_group>& process_mesh,
+                    index_type const* const local_global_mapping,
+                    std::size_t const size,
+                    index_type const offset)
+{
+    auto const lookup_start = local_global_mapping[0];
+    auto const lookup_size  = local_global_mapping[size - 1] - lookup_start + 1;
+
+    // Partitions usually include boundary nodes numbered at the start of the
+    // mesh and span most of the global range, where a table over the range
+    // would cost memory proportional to the whole mesh.  Search the sorted
+    // mapping instead when the range is sparsely populated.
+    if (static_cast<std::size_t>(lookup_size) > 4 * size)
+    {
+        auto const last = local_global_mapping + size;
+
+        for (auto& group : process_mesh)
+        {
+            auto const first = group.node_indices.data<index_type>();
+            auto const count = static_cast<std::int64_t>(group.node_indices.size());
+
+#pragma omp parallel for
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                first[i] = std::distance(local_global_mapping,
+                                         std::lower_bound(local_global_mapping, last, first[i])) +
+                           1 + offset;
+            }
+        }
+        return;
+    }
+
+    // Build a lookup table over the range of global indices in this process
+    // holding the local index (in the requested base) of each global index
+    std::unique_ptr<index_type[]> lookup(new index_type[lookup_size]);
+
+    for (std::size_t local = 0; local < size; ++local)
+    {
+        lookup[local_global_mapping[local] - lookup_start] = local + 1 + offset;
+    }
+
+    for (auto& group : process_mesh)
+    {
+        auto const first = group.node_indices.data<index_type>();
+
+        renumber_indices(first, first + group.node_indices.size(), lookup.get(), lookup_start);
+    }
+}
+}
+
+void mesh_reader::write(bool const print_indices) const
+{
+    output_options options;
+    options.print_indices = print_indices;
+
+    write(options);
+}
+
+void mesh_reader::write(output_options const& options) const
+{
+    if (options.single_file && m_extracted_partition >= 0)
+    {
+        throw std::domain_error("A single file output requires the complete mesh of " +
+                                input_file_name);
+    }
+
+    if (options.statistics && m_extracted_partition >= 0)
+    {
+        throw std::domain_error("The statistics require the complete mesh of " + input_file_name);
+    }
+
+    // A reader of a single partition only writes that partition
+    auto const first = std::max(m_extracted_partition, 0);
+    auto const last  = m_extracted_partition < 0 ? m_partitions : first + 1;
+
+    std::vector<std::string> partitions(options.single_file ? m_partitions : 0);
+
+    // Build the shared adjacency upfront so its construction runs in parallel
+    if (m_partition_options.halo_depth > 0 && m_partitions > 1) adjacency();
+
+    if (m_partition_options.skin || (options.statistics && m_partitions > 1)) skin();
+
+    std::vector<partition_statistics> measured(options.statistics ? m_partitions : 0);
+
+    // Exceptions cannot propagate out of a parallel region
+    std::exception_ptr error, write_error;
+
+    auto const is_pipelined = options.pipeline && !options.single_file;
+
+    // Serialised partitions waiting for the writer thread
+    bounded_queue<std::pair<int, std::string>> pending(2 * std::thread::hardware_concurrency() + 2);
+
+    std::thread writer;
+
+    if (is_pipelined)
+    {
+        writer = std::thread([&] {
+            std::pair<int, std::string> serialised;
+
+            while (pending.pop(serialised))
+            {
+                try
+                {
+                    write_file(output_file_name(serialised.first, options), serialised.second);
+
+                    std::cout << std::string(2, ' ')
+                              << "Finished writing out JSON file for mesh partition "
+                              << serialised.first << "\n";
+                }
+                catch (...)
+                {
+                    write_error = std::current_exception();
+                    pending.close();
+                }
+            }
+        });
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int partition = first; partition < last; ++partition)
+    {
+        try
+        {
+            auto const local = make_partition(partition);
+
+            if (options.statistics) measured[partition] = measure(local);
+
+            auto contents = write_json(local, m_partitions > 1, options);
+
+            if (options.single_file)
+            {
+                partitions[partition] = std::move(contents);
+            }
+            else if (is_pipelined)
+            {
+                pending.push({partition, std::move(contents)});
+            }
+            else
+            {
+                write_file(output_file_name(partition, options), contents);
+
+#pragma omp critical
+                std::cout << std::string(2, ' ')
+                          << "Finished writing out JSON file for mesh partition " << partition
+                          << "\n";
+            }
+        }
+        catch (...)
+        {
+#pragma omp critical
+            error = std::current_exception();
+        }
+    }
+
+    if (is_pipelined)
+    {
+        pending.close();
+        writer.join();
+    }
+
+    if (error) std::rethrow_exception(error);
+    if (write_error) std::rethrow_exception(write_error);
+
+    if (options.single_file)
+    {
+        auto const file_name = output_file_name(0, options);
+
+        write_container(file_name, partitions, options.compress);
+
+        std::cout << std::string(2, ' ') << "Finished writing out " << m_partitions
+                  << " mesh partitions to " << file_name << "\n";
+    }
+
+    if (options.statistics) report(summarise(std::move(measured)));
+}
+
+mesh_statistics mesh_reader::statistics() const
+{
+    // The edge cut and the imbalance depend on every partition
+    if (m_extracted_partition >= 0)
+    {
+        throw std::domain_error("The statistics require the complete mesh of " + input_file_name);
+    }
+
+    if (m_partitions > 1) skin();
+
+    std::vector<partition_statistics> partitions(m_partitions);
+
+    // Exceptions cannot propagate out of a parallel region
+    std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int partition = 0; partition < m_partitions; ++partition)
+    {
+        try
+        {
+            partitions[partition] = measure(make_partition(partition));
+        }
+        catch (...)
+        {
+#pragma omp critical
+            error = std::current_exception();
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+
+    return summarise(std::move(partitions));
+}
+
+partition_statistics mesh_reader::measure(partition const& process_mesh) const
+{
+    partition_statistics result;
+
+    result.number = process_mesh.number();
+    result.nodes  = process_mesh.local_to_global().size();
+
+    // Only the elements of the highest dimension are counted, which excludes
+    // the boundary elements and the skin
+    int dimension = 0;
+    for (auto const& mesh : meshes)
+    {
+        dimension = std::max(dimension, element_dimension(mesh.first.second));
+    }
+
+    for (auto const& group : process_mesh.element_groups())
+    {
+        if (element_dimension(group.type_id) != dimension) continue;
+
+        result.elements += group.size();
+        result.cost += group.size() * element_cost(group.nodes_per_element);
+    }
+
+    std::vector<std::int64_t> interface_nodes;
+
+    for (auto const& interface : process_mesh.interfaces())
+    {
+        if (interface.node_ids.empty()) continue;
+
+        interface_nodes.insert(end(interface_nodes),
+                               begin(interface.node_ids),
+                               end(interface.node_ids));
+        ++result.neighbours;
+    }
+    std::sort(begin(interface_nodes), end(interface_nodes));
+
+    result.interface_nodes = std::distance(begin(interface_nodes),
+                                           std::unique(begin(interface_nodes),
+                                                       end(interface_nodes)));
+
+    if (m_partitions > 1)
+    {
+        auto const& boundary = skin();
+
+        auto const number = process_mesh.number();
+
+        result.cut_faces = std::count_if(begin(boundary.faces) + boundary.partition_offsets[number],
+                                         begin(boundary.faces) +
+                                             boundary.partition_offsets[number + 1],
+                                         [](auto const& face) { return face.neighbour != 0; });
+    }
+    return result;
+}
+
+void mesh_reader::report(mesh_statistics const& statistics) const
+{
+    std::cout << "\nPartition statistics for " << input_file_name << "\n\n"
+              << format_table(statistics) << "\n";
+
+    auto const file_name = input_file_name.substr(0, input_file_name.find_last_of('.')) +
+                           ".stats.json";
+
+    write_file(file_name, format_json(statistics));
+
+    std::cout << std::string(2, ' ') << "Finished writing out partition statistics to "
+              << file_name << "\n";
+}
+
+void mesh_reader::set_partition_options(partition_options const& options)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (options == m_partition_options) return;
+
+    m_partition_options = options;
+
+    partition_cache.clear();
+}
+
+void mesh_reader::set_format(NodalOrdering const ordering,
+                             IndexingBase const base,
+                             distributed const distributed_option)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (useZeroBasedIndexing == (base == IndexingBase::Zero) &&
+        useLocalNodalConnectivity == (ordering == NodalOrdering::Local) &&
+        is_feti_format == (distributed_option == distributed::feti))
+    {
+        return;
+    }
+
+    useZeroBasedIndexing      = base == IndexingBase::Zero;
+    useLocalNodalConnectivity = ordering == NodalOrdering::Local;
+    is_feti_format            = distributed_option == distributed::feti;
+
+    partition_cache.clear();
+}
+
+std::shared_ptr<partition const> mesh_reader::local_mesh(int const partition_number) const
+{
+    if (partition_number < 0 || partition_number >= m_partitions)
+    {
+        throw std::out_of_range("Partition " + std::to_string(partition_number) +
+                                " does not exist in " + input_file_name);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+
+        auto const found = partition_cache.find(partition_number);
+
+        if (found != end(partition_cache)) return found->second;
+    }
+
+    // Assemble outside of the lock so different partitions are built concurrently
+    auto local = std::make_shared<partition const>(make_partition(partition_number));
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    return partition_cache.emplace(partition_number, std::move(local)).first->second;
+}
+
+std::string mesh_reader::write_partition(int const partition_number,
+                                         output_options const& options) const
+{
+    return write_json(*local_mesh(partition_number), m_partitions > 1, options);
+}
+
+partition mesh_reader::make_partition(int const partition_number) const
+{
+    if (m_extracted_partition >= 0)
+    {
+        if (partition_number != m_extracted_partition)
+        {
+            throw std::out_of_range("Partition " + std::to_string(partition_number) +
+                                    " was not read from " + input_file_name);
+        }
+        if (m_partition_options.halo_depth > 0)
+        {
+            throw std::domain_error("Halo layers require the complete mesh of " +
+                                    input_file_name);
+        }
+    }
+
+    partition local(partition_number);
+
+    local.m_element_groups = fill_process_mesh(partition_number + 1);
+
+    if (m_partition_options.colour) colour_process_mesh(local.m_element_groups);
+
+    local.m_local_to_global = fillLocalToGlobalMap(local.m_element_groups);
+
+    local.m_nodes = fillLocalNodeList(local.m_local_to_global);
+
+    if (m_partition_options.adjacency)
+    {
+        auto const element_nodes = fill_element_nodes(local.m_element_groups,
+                                                      local.m_local_to_global);
+
+        local.m_node_elements = transpose(element_nodes, local.m_local_to_global.size());
+        local.m_nodal_graph   = node_graph(element_nodes, local.m_node_elements);
+    }
+
+    // The skin nodes are a subset of the nodes of the partition
+    fill_skin(partition_number, local.m_element_groups);
+
+    local.m_halo = fill_halo(partition_number, local.m_local_to_global);
+
+    convert_indices(local.m_element_groups, local.m_local_to_global);
+
+    local.m_interfaces = fill_interfaces(partition_number, local.m_interface_nodes);
+
+    fill_schedules(partition_number, local.m_local_to_global, local.m_interfaces);
+
+    return local;
+}
+
+std::string mesh_reader::output_file_name(int const partition_number,
+                                          output_options const& options) const
+{
+    std::string file_name = input_file_name.substr(0, input_file_name.find_last_of('.'));
+
+    if (options.single_file)
+    {
+        file_name += ".meshes";
+    }
+    else
+    {
+        file_name += ".mesh";
+
+        if (m_partitions > 1) file_name += std::to_string(partition_number);
+
+        if (options.compress) file_name += ".gz";
+    }
+    return file_name;
+}
+
+std::vector<element_group> mesh_reader::fill_process_mesh(int const process_id) const
+{
+    std::vector<element_group> process_mesh;
+
+    // Find all of the elements which belong to this process
+    for (auto const& mesh : meshes)
+    {
+        element_group group{mesh.first.first,
+                            mesh.first.second,
+                            mapElementData(mesh.first.second),
+                            {},
+                            index_array(use_narrow_indices),
+                            {}};
+
+        // Copy the element data into the process mesh
+        for (auto const& element : mesh.second)
+        {
+            if (element.isOwnedByProcess(process_id))
+            {
+                auto const& nodes = element.node_indices();
+
+                group.ids.push_back(element.id());
+                group.node_indices.append(begin(nodes), end(nodes));
+            }
+        }
+
+        if (group.size() > 0)
+        {
+            process_mesh.push_back(std::move(group));
+        }
+    }
+    return process_mesh;
+}
+
+void mesh_reader::colour_process_mesh(std::vector<element_group>& process_mesh) const
+{
+    for (auto& group : process_mesh)
+    {
+        auto const nodes_per_element = group.nodes_per_element;
+
+        // Number the nodes of the group consecutively for the graphs
+        std::vector<std::int64_t> group_nodes(group.node_indices.size());
+        for (std::size_t i = 0; i < group_nodes.size(); ++i)
+        {
+            group_nodes[i] = group.node_indices[i];
+        }
+
+        auto unique_nodes = group_nodes;
+        std::sort(begin(unique_nodes), end(unique_nodes));
+        unique_nodes.erase(std::unique(begin(unique_nodes), end(unique_nodes)), end(unique_nodes));
+
+        csr_graph element_nodes;
+        element_nodes.offsets.resize(group.size() + 1);
+        element_nodes.indices.resize(group_nodes.size());
+
+        for (std::size_t element = 0; element <= group.size(); ++element)
+        {
+            element_nodes.offsets[element] = element * nodes_per_element;
+        }
+
+#pragma omp parallel for
+        for (std::int64_t i = 0; i < static_cast<std::int64_t>(group_nodes.size()); ++i)
+        {
+            element_nodes.indices[i] = std::distance(begin(unique_nodes),
+                                                     std::lower_bound(begin(unique_nodes),
+                                                                      end(unique_nodes),
+                                                                      group_nodes[i]));
+        }
+
+        auto const colours = colour_elements(element_nodes,
+                                             transpose(element_nodes, unique_nodes.size()));
+
+        // Stable counting sort of the elements by colour
+        group.colour_offsets.assign(1, 0);
+        for (auto const colour : colours)
+        {
+            if (colour + 2 > static_cast<std::int32_t>(group.colour_offsets.size()))
+            {
+                group.colour_offsets.resize(colour + 2, 0);
+            }
+            ++group.colour_offsets[colour + 1];
+        }
+        std::partial_sum(begin(group.colour_offsets),
+                         end(group.colour_offsets),
+                         begin(group.colour_offsets));
+
+        std::vector<std::int64_t> order(group.size());
+        std::vector<std::int64_t> cursor(begin(group.colour_offsets),
+                                         end(group.colour_offsets) - 1);
+
+        for (std::size_t element = 0; element < colours.size(); ++element)
+        {
+            order[cursor[colours[element]]++] = element;
+        }
+
+        std::vector<int> ids(group.size());
+        std::transform(begin(order), end(order), begin(ids), [&group](auto const element) {
+            return group.ids[element];
+        });
+        group.ids = std::move(ids);
+
+        group.node_indices.visit([&](auto const first, auto const last) {
+            using index_type = std::decay_t<decltype(*first)>;
+
+            std::vector<index_type> permuted(std::distance(first, last));
+
+            for (std::size_t position = 0; position < order.size(); ++position)
+            {
+                std::copy_n(first + order[position] * nodes_per_element,
+                            nodes_per_element,
+                            begin(permuted) + position * nodes_per_element);
+            }
+            std::copy(begin(permuted), end(permuted), first);
+        });
+    }
+}
+
+index_array mesh_reader::fillLocalToGlobalMap(std::vector<element_group> const& process_mesh) const
+{
+    index_array local_global_mapping(use_narrow_indices);
+
+    for (auto const& group : process_mesh)
+    {
+        local_global_mapping.append(group.node_indices);
+    }
+
+    // Sort and remove duplicates
+    local_global_mapping.resize(local_global_mapping.visit([](auto const first, auto const last) {
+        std::sort(first, last);
+        return static_cast<std::size_t>(std::distance(first, std::unique(first, last)));
+    }));
+
+    return local_global_mapping;
+}
+
+void mesh_reader::convert_indices(std::vector<element_group>& process_mesh,
+                                  index_array& local_global_mapping) const
+{
+    std::int32_t const offset = useZeroBasedIndexing ? -1 : 0;
+
+    if (useLocalNodalConnectivity && !local_global_mapping.empty())
+    {
+        local_global_mapping.visit([&](auto const first, auto const last) {
+            using index_type = std::decay_t<decltype(*first)>;
+
+            renumber_local<index_type>(process_mesh, first, std::distance(first, last), offset);
+        });
+    }
+    else if (useZeroBasedIndexing)
+    {
+        for (auto& group : process_mesh)
+        {
+            group.node_indices.visit(
+                [&](auto const first, auto const last) { shift_indices(first, last, offset); });
+        }
+    }
+
+    if (useZeroBasedIndexing)
+    {
+        for (auto& group : process_mesh)
+        {
+            std::transform(begin(group.ids), end(group.ids), begin(group.ids), [](auto const id) {
+                return id - 1;
+            });
+        }
+        local_global_mapping.visit(
+            [&](auto const first, auto const last) { shift_indices(first, last, offset); });
+    }
+}
+
+node_list mesh_reader::fillLocalNodeList(index_array const& local_global_mapping) const
+{
+    return nodal_data.gather(local_global_mapping, useZeroBasedIndexing ? -1 : 0);
+}
+
+csr_graph mesh_reader::fill_element_nodes(std::vector<element_group> const& process_mesh,
+                                          index_array const& local_global_mapping) const
+{
+    csr_graph element_nodes;
+
+    for (auto const& group : process_mesh)
+    {
+        for (std::size_t element = 0; element < group.size(); ++element)
+        {
+            element_nodes.offsets.push_back(element_nodes.offsets.back() +
+                                            group.nodes_per_element);
+        }
+    }
+    element_nodes.indices.resize(element_nodes.offsets.back());
+
+    local_global_mapping.visit([&](auto const first, auto const last) {
+        std::int64_t start = 0;
+
+        for (auto const& group : process_mesh)
+        {
+            auto const size = static_cast<std::int64_t>(group.node_indices.size());
+
+#pragma omp parallel for
+            for (std::int64_t i = 0; i < size; ++i)
+            {
+                element_nodes.indices[start + i] =
+                    std::distance(first, std::lower_bound(first, last, group.node_indices[i]));
+            }
+            start += size;
+        }
+    });
+    return element_nodes;
+}
+
+mesh_reader::mesh_adjacency const& mesh_reader::adjacency() const
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (m_adjacency) return *m_adjacency;
+
+    auto graph = std::make_unique<mesh_adjacency>();
+
+    // Element to node graph over all elements using node slots
+    csr_graph element_nodes;
+
+    for (auto const& mesh : meshes)
+    {
+        graph->groups.push_back(&mesh);
+
+        for (auto const& element : mesh.second)
+        {
+            graph->elements.push_back(&element);
+            graph->element_groups.push_back(graph->groups.size() - 1);
+
+            for (auto const node_index : element.node_indices())
+            {
+                element_nodes.indices.push_back(nodal_data.slot(node_index));
+            }
+            element_nodes.offsets.push_back(element_nodes.indices.size());
+        }
+    }
+
+    if (std::find(begin(element_nodes.indices), end(element_nodes.indices), -1) !=
+        end(element_nodes.indices))
+    {
+        throw std::domain_error("An element in " + input_file_name +
+                                " references a node that does not exist");
+    }
+
+    graph->node_elements = transpose(element_nodes, nodal_data.size());
+
+    graph->node_owners.resize(nodal_data.size());
+
+#pragma omp parallel for
+    for (std::int64_t slot = 0; slot < static_cast<std::int64_t>(nodal_data.size()); ++slot)
+    {
+        auto owner = std::numeric_limits<std::int32_t>::max();
+
+        for (auto const element : graph->node_elements.row(slot))
+        {
+            owner = std::min(owner, graph->elements[element]->owner_process());
+        }
+        graph->node_owners[slot] = owner;
+    }
+
+    m_adjacency = std::move(graph);
+
+    return *m_adjacency;
+}
+
+mesh_reader::mesh_skin const& mesh_reader::skin() const
+{
+    // The elements are taken from the adjacency, which acquires the lock itself
+    auto const& graph = adjacency();
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (m_skin) return *m_skin;
+
+    // Only the elements of the highest dimension bound the mesh
+    int dimension = 0;
+    for (auto const group : graph.groups)
+    {
+        dimension = std::max(dimension, element_dimension(group->first.second));
+    }
+
+    auto const elements = static_cast<std::int64_t>(graph.elements.size());
+
+    auto const faces_of = [&](std::int64_t const element) -> std::vector<element_face> const& {
+        static std::vector<element_face> const none;
+
+        auto const type_id = graph.groups[graph.element_groups[element]]->first.second;
+
+        return element_dimension(type_id) == dimension ? element_faces(type_id) : none;
+    };
+
+    std::vector<std::int64_t> face_offsets(elements + 1, 0);
+    for (std::int64_t element = 0; element < elements; ++element)
+    {
+        face_offsets[element + 1] = face_offsets[element] + faces_of(element).size();
+    }
+
+    // The face key is given by the sorted vertices of the face
+    using face_key = std::array<std::int64_t, 4>;
+
+    std::vector<face_key> keys(face_offsets.back());
+    std::vector<std::int64_t> face_elements(keys.size());
+
+    // Bucket the faces by the hash of the key so matching faces meet in the
+    // same bucket, which is then sorted independently of the other buckets
+    auto const buckets = std::max(std::int64_t(1), static_cast<std::int64_t>(keys.size() / 8));
+
+    csr_graph face_buckets;
+    face_buckets.offsets.resize(keys.size() + 1);
+    face_buckets.indices.resize(keys.size());
+    std::iota(begin(face_buckets.offsets), end(face_buckets.offsets), 0);
+
+#pragma omp parallel for
+    for (std::int64_t element = 0; element < elements; ++element)
+    {
+        auto const& nodes = graph.elements[element]->node_indices();
+
+        auto face_index = face_offsets[element];
+
+        for (auto const& face : faces_of(element))
+        {
+            auto& key = keys[face_index];
+
+            key.fill(-1);
+            for (int vertex = 0; vertex < face.vertices; ++vertex)
+            {
+                key[vertex] = nodes[face.nodes[vertex]];
+            }
+            std::sort(begin(key), begin(key) + face.vertices);
+
+            std::uint64_t hash = 0;
+            for (auto const node : key)
+            {
+                hash = hash * 1000003 ^ static_cast<std::uint64_t>(node);
+            }
+            face_elements[face_index]        = element;
+            face_buckets.indices[face_index] = hash % buckets;
+
+            ++face_index;
+        }
+    }
+
+    auto const bucket_faces = transpose(face_buckets, buckets);
+
+    auto result = std::make_unique<mesh_skin>();
+
+    // A face appearing once is on the exterior and a face appearing twice with
+    // different owners is on an interface.  Non-manifold faces are ignored.
+#pragma omp parallel
+    {
+        std::vector<skin_face> found;
+
+#pragma omp for schedule(dynamic, 256)
+        for (std::int64_t bucket = 0; bucket < buckets; ++bucket)
+        {
+            auto const row = bucket_faces.row(bucket);
+
+            std::vector<std::int64_t> faces(row.begin(), row.end());
+
+            std::sort(begin(faces), end(faces), [&keys](auto const left, auto const right) {
+                return std::tie(keys[left], left) < std::tie(keys[right], right);
+            });
+
+            for (std::size_t first = 0, last = 0; first < faces.size(); first = last)
+            {
+                last = first + 1;
+                while (last < faces.size() && keys[faces[last]] == keys[faces[first]]) ++last;
+
+                auto const local_face = [&](auto const face) -> std::int32_t {
+                    return face - face_offsets[face_elements[face]];
+                };
+
+                if (last - first == 1)
+                {
+                    found.push_back({face_elements[faces[first]], local_face(faces[first]), 0});
+                }
+                else if (last - first == 2)
+                {
+                    auto const left  = face_elements[faces[first]];
+                    auto const right = face_elements[faces[first + 1]];
+
+                    auto const left_owner  = graph.elements[left]->owner_process();
+                    auto const right_owner = graph.elements[right]->owner_process();
+
+                    if (left_owner != right_owner)
+                    {
+                        found.push_back({left, local_face(faces[first]), right_owner});
+                        found.push_back({right, local_face(faces[first + 1]), left_owner});
+                    }
+                }
+            }
+        }
+
+#pragma omp critical
+        result->faces.insert(end(result->faces), begin(found), end(found));
+    }
+
+    auto const owner = [&graph](skin_face const& face) {
+        return graph.elements[face.element]->owner_process();
+    };
+
+    std::sort(begin(result->faces), end(result->faces), [&](auto const& left, auto const& right) {
+        return std::make_tuple(owner(left), left.element, left.face) <
+               std::make_tuple(owner(right), right.element, right.face);
+    });
+
+    result->partition_offsets.resize(m_partitions + 1);
+    for (int partition = 0; partition <= m_partitions; ++partition)
+    {
+        result->partition_offsets[partition] =
+            std::distance(begin(result->faces),
+                          std::lower_bound(begin(result->faces),
+                                           end(result->faces),
+                                           partition + 1,
+                                           [&](auto const& face, auto const process_id) {
+                                               return owner(face) < process_id;
+                                           }));
+    }
+
+    m_skin = std::move(result);
+
+    return *m_skin;
+}
+
+void mesh_reader::fill_skin(int const partition_number,
+                            std::vector<element_group>& process_mesh) const
+{
+    if (!m_partition_options.skin) return;
+
+    auto const& graph = adjacency();
+    auto const& faces = skin().faces;
+
+    auto const& offsets = skin().partition_offsets;
+
+    // Exterior before interface faces, then by the element type of the face
+    std::map<std::pair<bool, std::int32_t>, element_group> groups;
+
+    for (auto i = offsets[partition_number]; i < offsets[partition_number + 1]; ++i)
+    {
+        auto const& element = *graph.elements[faces[i].element];
+
+        auto const type_id = graph.groups[graph.element_groups[faces[i].element]]->first.second;
+
+        auto const& face = element_faces(type_id)[faces[i].face];
+
+        auto const key = std::make_pair(faces[i].neighbour != 0, face.type_id);
+
+        auto group = groups.find(key);
+
+        if (group == end(groups))
+        {
+            group = groups
+                        .emplace(key,
+                                 element_group{key.first ? "skin_interface" : "skin_exterior",
+                                               face.type_id,
+                                               mapElementData(face.type_id),
+                                               {},
+                                               index_array(use_narrow_indices),
+                                               {}})
+                        .first;
+        }
+
+        group->second.ids.push_back(element.id());
+
+        for (auto const node : face.nodes)
+        {
+            auto const node_id = element.node_indices()[node];
+            group->second.node_indices.append(&node_id, &node_id + 1);
+        }
+    }
+
+    for (auto& group : groups)
+    {
+        process_mesh.push_back(std::move(group.second));
+    }
+}
+
+partition_halo mesh_reader::fill_halo(int const partition_number,
+                                      index_array const& local_global_mapping) const
+{
+    partition_halo halo;
+
+    if (m_partition_options.halo_depth < 1 || m_partitions < 2) return halo;
+
+    halo.depth = m_partition_options.halo_depth;
+
+    auto const& graph = adjacency();
+
+    auto const process_id = partition_number + 1;
+
+    std::vector<std::int64_t> local_ids(local_global_mapping.size());
+    for (std::size_t local = 0; local < local_ids.size(); ++local)
+    {
+        local_ids[local] = local_global_mapping[local];
+    }
+
+    auto const is_local = [&local_ids](auto const node_id) {
+        return std::binary_search(begin(local_ids), end(local_ids), node_id);
+    };
+
+    // Grow the halo one layer at a time from the nodes discovered in the
+    // previous layer, starting from the nodes of the partition
+    std::vector<std::int64_t> frontier(local_ids.size());
+    std::transform(begin(local_ids), end(local_ids), begin(frontier), [this](auto const id) {
+        return nodal_data.slot(id);
+    });
+
+    std::unordered_set<std::int64_t> visited_elements;
+    std::vector<std::pair<std::int64_t, std::int32_t>> halo_elements;
+
+    std::unordered_set<std::int64_t> visited_nodes;
+    std::vector<std::int64_t> halo_ids;
+
+    for (int layer = 1; layer <= halo.depth && !frontier.empty(); ++layer)
+    {
+        std::vector<std::int64_t> layer_elements;
+
+        for (auto const slot : frontier)
+        {
+            for (auto const element : graph.node_elements.row(slot))
+            {
+                if (!graph.elements[element]->isOwnedByProcess(process_id) &&
+                    visited_elements.insert(element).second)
+                {
+                    layer_elements.push_back(element);
+                }
+            }
+        }
+        std::sort(begin(layer_elements), end(layer_elements));
+
+        frontier.clear();
+
+        for (auto const element : layer_elements)
+        {
+            halo_elements.emplace_back(element, layer);
+
+            for (auto const node_id : graph.elements[element]->node_indices())
+            {
+                if (!is_local(node_id) && visited_nodes.insert(node_id).second)
+                {
+                    halo_ids.push_back(node_id);
+                    frontier.push_back(nodal_data.slot(node_id));
+                }
+            }
+        }
+    }
+
+    // Order the elements as the element groups of the mesh and the nodes by id
+    std::sort(begin(halo_elements), end(halo_elements));
+    std::sort(begin(halo_ids), end(halo_ids));
+
+    std::int64_t const offset = useZeroBasedIndexing ? -1 : 0;
+
+    auto const convert = [&](std::int64_t const node_id) -> std::int64_t {
+        if (!useLocalNodalConnectivity) return node_id + offset;
+
+        auto const local = std::lower_bound(begin(local_ids), end(local_ids), node_id);
+
+        if (local != end(local_ids) && *local == node_id)
+        {
+            return std::distance(begin(local_ids), local) + 1 + offset;
+        }
+        return local_ids.size() +
+               std::distance(begin(halo_ids),
+                             std::lower_bound(begin(halo_ids), end(halo_ids), node_id)) +
+               1 + offset;
+    };
+
+    std::int32_t current_group = -1;
+
+    for (auto const& halo_element : halo_elements)
+    {
+        auto const& element = *graph.elements[halo_element.first];
+
+        if (graph.element_groups[halo_element.first] != current_group)
+        {
+            current_group    = graph.element_groups[halo_element.first];
+            auto const& mesh = *graph.groups[current_group];
+
+            halo.element_groups.push_back({mesh.first.first,
+                                           mesh.first.second,
+                                           mapElementData(mesh.first.second),
+                                           {},
+                                           index_array(use_narrow_indices),
+                                           {}});
+            halo.element_owners.emplace_back();
+            halo.element_layers.emplace_back();
+        }
+
+        auto& group = halo.element_groups.back();
+
+        std::vector<std::int64_t> connectivity(element.node_indices().size());
+        std::transform(begin(element.node_indices()),
+                       end(element.node_indices()),
+                       begin(connectivity),
+                       convert);
+
+        group.ids.push_back(element.id() + offset);
+        group.node_indices.append(begin(connectivity), end(connectivity));
+
+        halo.element_owners.back().push_back(element.owner_process() + offset);
+        halo.element_layers.back().push_back(halo_element.second);
+    }
+
+    index_array halo_mapping(use_narrow_indices);
+    halo_mapping.append(begin(halo_ids), end(halo_ids));
+
+    halo.nodes = nodal_data.gather(halo_mapping, offset);
+
+    for (auto const node_id : halo_ids)
+    {
+        halo.node_owners.push_back(graph.node_owners[nodal_data.slot(node_id)] + offset);
+    }
+    return halo;
+}
+
+std::vector<partition_interface> mesh_reader::fill_interfaces(int const partition_number,
+                                                              std::int64_t& interface_nodes) const
+{
+    std::vector<partition_interface> interfaces;
+
+    std::int32_t const offset = useZeroBasedIndexing ? -1 : 0;
+
+    interface_nodes = 0;
+
+    // The numbering of an extracted partition is taken from the index
+    auto const from_ghosts = m_interface_detection == interface_detection::ghost_tags &&
+                             m_mesh_has_ghosts;
+
+    auto const& interface_offsets = from_ghosts ? m_interface_offsets : m_shared_node_offsets;
+
+    for (auto const& interface : interfaceElementMap)
+    {
+        auto const master_partition = interface.first.first;
+        auto const slave_partition  = interface.first.second;
+
+        if ((is_feti_format && master_partition < slave_partition) ||
+            (!is_feti_format && partition_number == slave_partition - 1))
+        {
+            std::vector<std::int64_t> intersection;
+
+            // Find the common indices between the master and the slave
+            // partition and print these out for each process interface
+            auto const& v1 = interface.second;
+            auto const& v2 = interfaceElementMap.at({slave_partition, master_partition});
+
+            std::set_intersection(std::begin(v1),
+                                  std::end(v1),
+                                  std::begin(v2),
+                                  std::end(v2),
+                                  std::back_inserter(intersection));
+
+            auto const size = intersection.size();
+
+            if (partition_number == master_partition - 1 || partition_number == slave_partition - 1)
+            {
+                if (!is_feti_format)
+                {
+                    std::transform(begin(intersection),
+                                   end(intersection),
+                                   begin(intersection),
+                                   [offset](auto const node) { return node + offset; });
+                }
+
+                auto const global_start_id = is_feti_format && m_extracted_partition >= 0
+                                                 ? interface_offsets.at(interface.first)
+                                                 : interface_nodes;
+
+                interfaces.push_back({master_partition + offset,
+                                      slave_partition + offset,
+                                      partition_number == master_partition - 1 ? 1 : -1,
+                                      global_start_id,
+                                      std::move(intersection),
+                                      {},
+                                      {}});
+            }
+
+            if (is_feti_format) interface_nodes += size;
+        }
+    }
+
+    if (is_feti_format && m_extracted_partition >= 0)
+    {
+        interface_nodes = from_ghosts ? m_interface_node_total : m_shared_interface_node_total;
+    }
+
+    return interfaces;
+}
+
+void mesh_reader::fill_schedules(int const partition_number,
+                                 index_array const& local_global_mapping,
+                                 std::vector<partition_interface>& interfaces) const
+{
+    if (is_feti_format) return;
+
+    std::int32_t const offset = useZeroBasedIndexing ? -1 : 0;
+
+    std::int32_t const self = partition_number + 1 + offset;
+
+    // Every partition containing an interface node shares it with this
+    // partition, so the owner is the lowest of these and this partition
+    std::vector<std::pair<std::int64_t, std::int32_t>> node_owners;
+
+    for (auto const& interface : interfaces)
+    {
+        for (auto const node_id : interface.node_ids)
+        {
+            node_owners.emplace_back(node_id, std::min(self, interface.master));
+        }
+    }
+    std::sort(begin(node_owners), end(node_owners));
+
+    // Keep the lowest owner of each node
+    node_owners.erase(std::unique(begin(node_owners),
+                                  end(node_owners),
+                                  [](auto const& left, auto const& right) {
+                                      return left.first == right.first;
+                                  }),
+                      end(node_owners));
+
+    auto const owner = [&](std::int64_t const node_id) {
+        return std::lower_bound(begin(node_owners),
+                                end(node_owners),
+                                std::make_pair(node_id, std::numeric_limits<std::int32_t>::min()))
+            ->second;
+    };
+
+    auto const local_number = [&](std::int64_t const node_id) {
+        return local_global_mapping.visit([&](auto const first, auto const last) {
+            return std::distance(first, std::lower_bound(first, last, node_id)) + 1 + offset;
+        });
+    };
+
+    for (auto& interface : interfaces)
+    {
+        for (auto const node_id : interface.node_ids)
+        {
+            auto const node_owner = owner(node_id);
+
+            if (node_owner == self)
+            {
+                interface.send_ids.push_back(local_number(node_id));
+            }
+            else if (node_owner == interface.master)
+            {
+                interface.receive_ids.push_back(local_number(node_id));
+            }
+        }
+    }
+}
+
+std::string mesh_reader::write_json(partition const& process_mesh,
+                                    bool const is_decomposed,
+                                    output_options const& options) const
+{
+    auto const print_indices = options.print_indices;
+
+    auto const& nodalCoordinates     = process_mesh.nodes();
+    auto const& localToGlobalMapping = process_mesh.local_to_global();
+
+    coordinate_encoding const encode(options, m_bounding_box);
+
+    // Write out each file to Json format
+    Json::Value event;
+
+    if (options.precision != coordinate_precision::float64)
+    {
+        event["CoordinatePrecision"] = encode.header();
+    }
+
+    // Write out the nodal coordinates
+    event["Nodes"].append(write_json_nodes(nodalCoordinates, print_indices, encode));
+
+    for (auto const& group : process_mesh.element_groups())
+    {
+        event["Elements"].append(write_json_elements(group, print_indices));
+    }
+
+    if (m_partition_options.adjacency)
+    {
+        event["NodeToElement"] = write_json_graph(process_mesh.node_elements());
+        event["NodalGraph"]    = write_json_graph(process_mesh.nodal_graph());
+    }
+
+    if (is_decomposed)
+    {
+        auto& eventLocalToGlobalMap = event["LocalToGlobalMap"];
+        for (std::size_t local = 0; local < localToGlobalMapping.size(); ++local)
+        {
+            eventLocalToGlobalMap.append(Json::Int64(localToGlobalMapping[local]));
+        }
+
+        for (auto const& interface : process_mesh.interfaces())
+        {
+            Json::Value interface_group, nodal_numbers;
+
+            for (auto const& node_number : interface.node_ids)
+            {
+                nodal_numbers.append(Json::Int64(node_number));
+            }
+
+            if (is_feti_format)
+            {
+                interface_group["NodeIds"].append(nodal_numbers);
+
+                interface_group["Master"]        = interface.master;
+                interface_group["Slave"]         = interface.slave;
+                interface_group["Value"]         = interface.value;
+                interface_group["GlobalStartId"] = Json::Int64(interface.global_start_id);
+            }
+            else
+            {
+                interface_group["Indices"] = nodal_numbers;
+                interface_group["Process"] = interface.master;
+
+                interface_group["Send"]    = Json::Value(Json::arrayValue);
+                interface_group["Receive"] = Json::Value(Json::arrayValue);
+
+                for (auto const local : interface.send_ids)
+                {
+                    interface_group["Send"].append(Json::Int64(local));
+                }
+                for (auto const local : interface.receive_ids)
+                {
+                    interface_group["Receive"].append(Json::Int64(local));
+                }
+            }
+            event["Interface"].append(interface_group);
+        }
+
+        if (is_feti_format)
+        {
+            event["NumInterfaceNodes"] = Json::Int64(process_mesh.interface_nodes());
+        }
+
+        auto const& halo = process_mesh.halo();
+
+        if (halo.depth > 0)
+        {
+            auto& event_halo = event["Halo"];
+
+            event_halo["Depth"] = halo.depth;
+
+            for (std::size_t i = 0; i < halo.element_groups.size(); ++i)
+            {
+                auto halo_group = write_json_elements(halo.element_groups[i], print_indices);
+
+                for (std::size_t element = 0; element < halo.element_owners[i].size(); ++element)
+                {
+                    halo_group["Owners"].append(halo.element_owners[i][element]);
+                    halo_group["Layers"].append(halo.element_layers[i][element]);
+                }
+                event_halo["Elements"].append(halo_group);
+            }
+
+            // The global node numbers are always required to identify the halo nodes
+            auto halo_nodes = write_json_nodes(halo.nodes, true, encode);
+
+            for (auto const owner : halo.node_owners)
+            {
+                halo_nodes["Owners"].append(owner);
             }
+            event_halo["Nodes"] = halo_nodes;
         }
     }
-    Json::StyledWriter jsonwriter;
-    writer << jsonwriter.write(event);
-    writer.close();
+    std::string contents;
+
+    if (options.precision == coordinate_precision::float32)
+    {
+        // Nine significant digits recover every single precision value
+        Json::StreamWriterBuilder builder;
+        builder["indentation"]  = "   ";
+        builder["precision"]    = 9;
+        builder["commentStyle"] = "None";
+
+        contents = Json::writeString(builder, event) + "\n";
+    }
+    else
+    {
+        Json::StyledWriter jsonwriter;
+        contents = jsonwriter.write(event);
+    }
+
+    if (options.compress)
+    {
+        return compress_blocks(contents, options.compression_level);
+    }
+    return contents;
 }
 } // namespace imr
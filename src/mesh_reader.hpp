@@ -1,16 +1,25 @@
 
 #pragma once
 
+#include <iosfwd>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "adjacency.hpp"
 #include "element.hpp"
-#include "node.hpp"
+#include "element_group.hpp"
+#include "node_list.hpp"
+#include "partition.hpp"
+#include "statistics.hpp"
 
 namespace imr
 {
+struct mesh_index;
+
 /// Mesh partition nodal connectivity
 enum class NodalOrdering { Local, Global };
 
@@ -20,6 +29,85 @@ enum class IndexingBase { Zero, One };
 /// Ordering for distribution of mshes
 enum class distributed { feti, interprocess };
 
+/// Source of the nodes shared between partitions.  With ghost_tags the nodes
+/// shared by the ghost elements are used, falling back to shared_nodes for
+/// decomposed meshes written without ghost elements.  With shared_nodes every
+/// node of elements owned by different partitions is an interface node.
+enum class interface_detection { ghost_tags, shared_nodes };
+
+/// Precision of the nodal coordinates in the output files
+enum class coordinate_precision { float64, float32, quantised };
+
+/// Options controlling the files written by mesh_reader::write
+struct output_options
+{
+    /// Write out the element and node indices (results in file size increase)
+    bool print_indices = true;
+
+    /// Compress each output file into independently compressed gzip blocks
+    /// \sa compress_blocks
+    bool compress = false;
+
+    /// Compression level from 1 (fastest) to 9 (smallest)
+    int compression_level = 6;
+
+    /// Write every partition into a single container file \sa write_container
+    bool single_file = false;
+
+    /// Write the files on a separate thread while the following partitions
+    /// are assembled and serialised.  This has no effect for a single file.
+    bool pipeline = false;
+
+    /// Write the coordinates as double precision, single precision or as
+    /// integers on a uniform grid spanning the bounding box of the mesh.
+    /// Reduced precision is recorded under "CoordinatePrecision", where a
+    /// quantised coordinate q of axis i is origin[i] + q * scale.
+    coordinate_precision precision = coordinate_precision::float64;
+
+    /// Number of bits of the quantised coordinates from 1 to 52.  The error
+    /// is at most half the grid spacing, which is the largest extent of the
+    /// bounding box divided by 2^bits - 1.
+    int quantisation_bits = 20;
+
+    /// Print the quality of the decomposition as a table and write it as JSON
+    /// to a file with the extension ".stats.json" \sa mesh_statistics
+    bool statistics = false;
+};
+
+/// Options controlling the contents of each partition
+struct partition_options
+{
+    /// Number of layers of elements owned by neighbouring partitions to add
+    /// to each partition as a halo (ghost) region \sa partition_halo
+    int halo_depth = 0;
+
+    /// Add the boundary faces (edges for two dimensional meshes) of the
+    /// elements in each partition as element groups.  The faces on the
+    /// exterior of the mesh are grouped as "skin_exterior" and the faces
+    /// shared with a neighbouring partition are grouped as "skin_interface".
+    /// The id of each face is the id of the element it belongs to.
+    bool skin = false;
+
+    /// Build the node to element graph and the nodal graph of each partition
+    /// in compressed sparse row format \sa partition::nodal_graph
+    bool adjacency = false;
+
+    /// Order the elements of each element group by colour, where elements of
+    /// the same colour do not share a node \sa element_group::colour_offsets
+    bool colour = false;
+};
+
+inline bool operator==(partition_options const& left, partition_options const& right)
+{
+    return left.halo_depth == right.halo_depth && left.skin == right.skin &&
+           left.adjacency == right.adjacency && left.colour == right.colour;
+}
+
+inline bool operator!=(partition_options const& left, partition_options const& right)
+{
+    return !(left == right);
+}
+
 /// Gmsh element numbering scheme
 enum ELEMENT_TYPE_ID {
     // Standard linear elements
@@ -80,6 +168,20 @@ public:
                          IndexingBase const base,
                          distributed const distributed_option);
 
+    /// Read a single partition through the sidecar index of the mesh file,
+    /// which is built and written first if it is missing or out of date.
+    /// Only the elements owned by the partition, the ghost elements of its
+    /// neighbours and the nodes of these elements are parsed, so the time
+    /// scales with the size of the partition.  Only this partition can be
+    /// assembled or written, and refinement, node merging, halo layers and
+    /// single file output are not available \sa mesh_index
+    /// \param partition_number Zero based partition number
+    explicit mesh_reader(std::string const& input_file_name,
+                         int const partition_number,
+                         NodalOrdering const ordering,
+                         IndexingBase const base,
+                         distributed const distributed_option);
+
     ~mesh_reader() = default;
 
     /// Return a map of the physical names and the element data.
@@ -88,7 +190,7 @@ public:
     auto const& mesh() const { return meshes; }
 
     /// Return a list of the coordinates and Ids of the nodes
-    std::vector<node> const& nodes() const { return nodal_data; }
+    node_list const& nodes() const { return nodal_data; }
 
     /// Return the physical names associated with the mesh
     std::map<std::int32_t, std::string> const& names() const { return physicalGroupMap; }
@@ -100,15 +202,73 @@ public:
     /// that gmsh outputs and the local processor view that Murge expects.
     void write(bool const printIndices = true) const;
 
+    /// Write out the mesh for each partition \sa write
+    void write(output_options const& options) const;
+
     /// Return the number of decompositions in the mesh
     auto numberOfPartitions() const { return m_partitions; }
 
+    /// Set the options for the contents of each partition used by write()
+    /// and local_mesh().  This discards the partitions assembled previously
+    /// if the options are changed.
+    void set_partition_options(partition_options const& options);
+
+    /// Change the ordering, indexing base and distributed format of the
+    /// partitions without parsing the mesh again.  This discards the
+    /// partitions assembled previously if the format is changed.
+    void set_format(NodalOrdering const ordering,
+                    IndexingBase const base,
+                    distributed const distributed_option);
+
+    /// Select how the interfaces between the partitions are found.  This
+    /// discards the partitions assembled previously if the detection is changed.
+    void set_interface_detection(interface_detection const detection);
+
+    /// Uniformly refine every element of the mesh, where each level splits the
+    /// edges of the elements in two.  The children keep the physical group and
+    /// the partition tags of their parent so the partitions and interfaces are
+    /// preserved.  The new nodes are numbered after the existing nodes and the
+    /// elements are numbered from one in the order of the element groups.
+    /// This supports points, two node lines, three node triangles, four node
+    /// quadrilaterals and tetrahedra and eight node hexahedra, and discards
+    /// the partitions assembled previously.
+    /// \param levels Number of times to refine the mesh
+    void refine(int const levels = 1);
+
+    /// Merge the nodes closer than a tolerance into a single node, where each
+    /// node is replaced by the node with the lowest id within the tolerance.
+    /// The connectivity of every element and the interfaces are updated and
+    /// the partitions assembled previously are discarded.
+    /// \param relative_tolerance Tolerance relative to the diagonal of the
+    ///        bounding box of the nodes
+    /// \return number of nodes removed
+    std::int64_t merge_nodes(double const relative_tolerance = 1.0e-10);
+
+    /// Return the mesh of a single partition in the ordering, indexing base
+    /// and distributed format of the reader, which is the same data that
+    /// write() serialises.  The partition is assembled on first access and
+    /// shared with the reader until refine() or merge_nodes() is called or
+    /// set_partition_options(), set_format() or set_interface_detection()
+    /// changes the settings, which assembles the partition again on the next
+    /// access.  The returned partition remains valid while it is held.  This
+    /// is safe to call concurrently.
+    /// \param partition_number Zero based partition number
+    std::shared_ptr<partition const> local_mesh(int const partition_number) const;
+
+    /// \return quality of the decomposition, where the partitions are
+    /// assembled in parallel without being kept
+    mesh_statistics statistics() const;
+
+    /// \return contents of the output file of a single partition \sa write
+    /// \param partition_number Zero based partition number
+    std::string write_partition(int const partition_number, output_options const& options) const;
+
 private:
     /// Provide a reference to the nodes and dimensions that will be populated
     /// with the correct data based on the elementType
     /// \param elementTypeId gmsh element number
     /// \return number of nodes for the element
-    int mapElementData(int const elementTypeId);
+    int mapElementData(int const elementTypeId) const;
 
     /// Check the version of gmsh is support otherwise print out a warning
     /// \param gmshVersion
@@ -117,28 +277,152 @@ private:
     /// This method fills the datastructures \sa element \sa node
     void fillMesh();
 
+    /// Fill the datastructures of a single partition through the index,
+    /// which is rebuilt if it does not match the mesh file
+    void extract_partition(int const partition_number);
+
+    /// Fill the datastructures of a single partition from the locations in
+    /// the index \return false if a location does not hold the indexed line
+    bool read_indexed_partition(mesh_index const& index, int const partition_number);
+
+    /// Read an element from the current position of the mesh file
+    element read_element(std::istream& gmsh_file) const;
+
+    /// Add the nodes of an element shared between partitions to the interfaces
+    void add_interface_element(element const& shared_element);
+
+    /// Find the interfaces between the partitions \sa interface_detection
+    void fill_interface_map();
+
+    /// Add every node of elements owned by different partitions to the
+    /// interfaces between each pair of these partitions
+    void fill_shared_node_interfaces();
+
+    /// Replace every element by its children \sa refine
+    void refine_once();
+
+    /// Rebuild the interfaces and the index width after the elements or the
+    /// nodes have changed and discard the partitions and the adjacency
+    void mesh_changed();
+
+    /// Assemble the mesh of a zero based partition number
+    partition make_partition(int const partition_number) const;
+
+    /// Gather the elements owned by a process into contiguous element groups
+    /// \param process_id One based process (partition) number
+    std::vector<element_group> fill_process_mesh(int const process_id) const;
+
+    /// Colour the elements of each group and reorder them by colour
+    void colour_process_mesh(std::vector<element_group>& process_mesh) const;
+
     /// Return the local to global mapping for the nodal connectivities
-    std::vector<std::int64_t> fillLocalToGlobalMap(Mesh const& process_mesh) const;
+    index_array fillLocalToGlobalMap(std::vector<element_group> const& process_mesh) const;
 
-    /// Reorder the mesh to for each process
-    void reorderLocalMesh(Mesh& processMesh,
-                          std::vector<std::int64_t> const& local_global_mapping) const;
+    /// Convert the nodal connectivity to the local ordering (if requested) and
+    /// the indexing base in a single pass over each connectivity array, then
+    /// shift the element ids and the local to global mapping to the indexing base
+    void convert_indices(std::vector<element_group>& process_mesh,
+                         index_array& local_global_mapping) const;
 
     /// Gather the local process nodal coordinates using the local to global mapping.
     /// This is required to reduce the number of coordinates for each process.
+    /// The node ids are converted to the indexing base during the gather.
     /// \sa writeInJsonFormat
-    std::vector<node>
-    fillLocalNodeList(std::vector<std::int64_t> const& local_global_mapping) const;
+    node_list fillLocalNodeList(index_array const& local_global_mapping) const;
+
+    /// \return element to node graph of the element groups in zero based local
+    /// node numbers given by the position in the local to global mapping,
+    /// independent of the ordering and the indexing base of the connectivity
+    csr_graph fill_element_nodes(std::vector<element_group> const& process_mesh,
+                                 index_array const& local_global_mapping) const;
+
+    /// \return file name of the output for a zero based partition number
+    std::string output_file_name(int const partition_number, output_options const& options) const;
+
+    /// Adjacency of the complete mesh
+    struct mesh_adjacency
+    {
+        /// Every element in the mesh
+        std::vector<element const*> elements;
+
+        /// Index of the group in meshes for each element
+        std::vector<std::int32_t> element_groups;
+
+        /// Element groups of meshes in order
+        std::vector<Mesh::value_type const*> groups;
+
+        /// Elements containing each node, where the rows are node slots
+        csr_graph node_elements;
+
+        /// Lowest owning partition of the elements containing each node
+        std::vector<std::int32_t> node_owners;
+    };
+
+    /// \return adjacency of the complete mesh, built on first use
+    mesh_adjacency const& adjacency() const;
+
+    /// Face of an element on the boundary of a partition
+    struct skin_face
+    {
+        /// Index of the element in mesh_adjacency::elements
+        std::int64_t element;
+
+        /// Local face number of the element \sa element_faces
+        std::int32_t face;
+
+        /// One based partition on the other side of the face or zero for
+        /// a face on the exterior of the mesh
+        std::int32_t neighbour;
+    };
+
+    /// Boundary faces of the complete mesh
+    struct mesh_skin
+    {
+        /// Boundary faces ordered by owning partition and element
+        std::vector<skin_face> faces;
 
-    void write_json(Mesh const& process_mesh,
-                    std::vector<std::int64_t> const& local_global_mapping,
-                    std::vector<node> const& nodalCoordinates,
-                    int const process_number,
-                    bool const is_distributed,
-                    bool const printIndices) const;
+        /// Offset of the faces of each zero based partition in faces
+        std::vector<std::int64_t> partition_offsets;
+    };
+
+    /// \return boundary faces of the highest dimensional elements in the mesh,
+    /// built on first use by matching the faces of every element
+    mesh_skin const& skin() const;
+
+    /// Append the boundary faces of a zero based partition to its element groups
+    void fill_skin(int const partition_number, std::vector<element_group>& process_mesh) const;
+
+    /// Find the elements and nodes of the halo around a zero based partition
+    /// \param local_global_mapping Sorted global node numbers of the partition
+    partition_halo fill_halo(int const partition_number,
+                             index_array const& local_global_mapping) const;
+
+    /// Find the interfaces of a zero based partition number with its neighbours
+    /// \param interface_nodes Total number of interface nodes (FETI format)
+    std::vector<partition_interface> fill_interfaces(int const partition_number,
+                                                     std::int64_t& interface_nodes) const;
+
+    /// Fill the nodes sent to and received from each neighbour of a zero based
+    /// partition in the interprocess format \sa partition_interface::send_ids
+    /// \param local_global_mapping Sorted global node numbers of the partition
+    void fill_schedules(int const partition_number,
+                        index_array const& local_global_mapping,
+                        std::vector<partition_interface>& interfaces) const;
+
+    /// \return size of the partition and its interfaces \sa statistics
+    partition_statistics measure(partition const& process_mesh) const;
+
+    /// Print the statistics and write them to file \sa output_options::statistics
+    void report(mesh_statistics const& statistics) const;
+
+    /// Serialise the process mesh to JSON, compressing the result if requested
+    /// \return the contents of the output file for the partition
+    std::string write_json(partition const& process_mesh,
+                           bool const is_distributed,
+                           output_options const& options) const;
 
 private:
-    std::vector<node> nodal_data;
+    node_list nodal_data;
 
     Mesh meshes;
 
@@ -158,9 +442,42 @@ private:
     bool useZeroBasedIndexing;
     bool useLocalNodalConnectivity;
 
+    /// Store the partition connectivity and mappings with 32 bit indices
+    /// when the largest node id permits
+    bool use_narrow_indices = true;
+
+    /// Lower and upper corners of the box bounding the nodes of the mesh
+    std::pair<node_list::coordinate_type, node_list::coordinate_type> m_bounding_box;
+
     /// Output in FETI format
     bool is_feti_format = true;
 
+    interface_detection m_interface_detection = interface_detection::ghost_tags;
+
+    /// Zero based partition read through the index or -1 for the full mesh
+    int m_extracted_partition = -1;
+
+    /// Offsets of the FETI interfaces and the number of interface nodes of
+    /// the complete mesh for an extracted partition found from the ghost
+    /// elements and from the shared nodes
+    std::map<owner_sharer_t, std::int64_t> m_interface_offsets, m_shared_node_offsets;
+    std::int64_t m_interface_node_total = 0, m_shared_interface_node_total = 0;
+
+    /// Ghost elements are present in the complete mesh of an extracted partition
+    bool m_mesh_has_ghosts = false;
+
     int m_partitions = 1;
+
+    partition_options m_partition_options;
+
+    /// Partitions assembled through local_mesh
+    mutable std::map<int, std::shared_ptr<partition const>> partition_cache;
+
+    mutable std::unique_ptr<mesh_adjacency> m_adjacency;
+
+    mutable std::unique_ptr<mesh_skin> m_skin;
+
+    /// Guards the partition cache, the adjacency and the skin
+    mutable std::mutex cache_mutex;
 };
 } // namespace imr
@@ -0,0 +1,149 @@
+
+#include "node_list.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace imr
+{
+void node_list::reserve(std::size_t const size)
+{
+    m_ids.reserve(size);
+    m_coordinates.reserve(size);
+}
+
+void node_list::resize(std::size_t const size)
+{
+    m_ids.resize(size);
+    m_coordinates.resize(size);
+}
+
+void node_list::push_back(std::int64_t const id, coordinate_type const& coordinates)
+{
+    m_ids.push_back(id);
+    m_coordinates.push_back(coordinates);
+}
+
+auto node_list::bounding_box() const -> std::pair<coordinate_type, coordinate_type>
+{
+    if (m_coordinates.empty()) return {coordinate_type{}, coordinate_type{}};
+
+    auto const size = static_cast<std::int64_t>(m_coordinates.size());
+
+    auto lower = m_coordinates[0], upper = m_coordinates[0];
+
+#pragma omp parallel
+    {
+        auto local_lower = lower, local_upper = upper;
+
+#pragma omp for nowait
+        for (std::int64_t slot = 0; slot < size; ++slot)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                local_lower[i] = std::min(local_lower[i], m_coordinates[slot][i]);
+                local_upper[i] = std::max(local_upper[i], m_coordinates[slot][i]);
+            }
+        }
+
+#pragma omp critical
+        for (int i = 0; i < 3; ++i)
+        {
+            lower[i] = std::min(lower[i], local_lower[i]);
+            upper[i] = std::max(upper[i], local_upper[i]);
+        }
+    }
+    return {lower, upper};
+}
+
+void node_list::build_index()
+{
+    m_slots.clear();
+    m_sorted_slots.clear();
+
+    if (m_ids.empty())
+    {
+        m_min_id = m_max_id = 0;
+        m_is_consecutive    = true;
+        return;
+    }
+
+    auto const minmax = std::minmax_element(begin(m_ids), end(m_ids));
+
+    m_min_id = *minmax.first;
+    m_max_id = *minmax.second;
+
+    auto const range = m_max_id - m_min_id + 1;
+
+    m_is_consecutive = range == static_cast<std::int64_t>(m_ids.size()) &&
+                       std::is_sorted(begin(m_ids), end(m_ids));
+
+    if (m_is_consecutive) return;
+
+    // Use a table when the ids are reasonably dense and fall back to a
+    // binary search over the sorted ids for widely spread numbering
+    if (range <= 4 * static_cast<std::int64_t>(m_ids.size()))
+    {
+        m_slots.assign(range, -1);
+
+        for (std::size_t slot = 0; slot < m_ids.size(); ++slot)
+        {
+            m_slots[m_ids[slot] - m_min_id] = slot;
+        }
+    }
+    else
+    {
+        m_sorted_slots.reserve(m_ids.size());
+
+        for (std::size_t slot = 0; slot < m_ids.size(); ++slot)
+        {
+            m_sorted_slots.emplace_back(m_ids[slot], slot);
+        }
+        std::sort(begin(m_sorted_slots), end(m_sorted_slots));
+    }
+}
+
+std::int64_t node_list::slot(std::int64_t const id) const noexcept
+{
+    if (m_ids.empty() || id < m_min_id || id > m_max_id) return -1;
+
+    if (m_is_consecutive) return id - m_min_id;
+
+    if (!m_slots.empty()) return m_slots[id - m_min_id];
+
+    auto const found = std::lower_bound(begin(m_sorted_slots),
+                                        end(m_sorted_slots),
+                                        std::make_pair(id, std::int64_t(-1)));
+
+    return found != end(m_sorted_slots) && found->first == id ? found->second : -1;
+}
+
+node_list node_list::gather(index_array const& ids, std::int64_t const id_offset) const
+{
+    node_list gathered;
+    gathered.resize(ids.size());
+
+    // Resolve the slots first so the copy below is a tight indexed loop over
+    // (usually) increasing slots that the hardware prefetcher can follow
+    std::vector<std::int64_t> slots(ids.size());
+
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        slots[i] = slot(ids[i]);
+
+        if (slots[i] < 0)
+        {
+            throw std::domain_error("Node " + std::to_string(ids[i]) +
+                                    " is referenced by an element but does not exist");
+        }
+    }
+
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        gathered.m_ids[i]         = m_ids[slots[i]] + id_offset;
+        gathered.m_coordinates[i] = m_coordinates[slots[i]];
+    }
+    return gathered;
+}
+} // namespace imr
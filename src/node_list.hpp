@@ -0,0 +1,81 @@
+
+#pragma once
+
+#include "index_array.hpp"
+#include "node.hpp"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace imr
+{
+/// node_list stores the ids and the coordinates of the nodes in separate
+/// arrays together with an index from the node id to its position (slot)
+/// in the arrays.  Node ids do not need to be dense, ordered or start at one.
+class node_list
+{
+public:
+    using coordinate_type = std::array<double, 3>;
+
+public:
+    std::size_t size() const noexcept { return m_ids.size(); }
+
+    bool empty() const noexcept { return m_ids.empty(); }
+
+    void reserve(std::size_t const size);
+
+    void resize(std::size_t const size);
+
+    void push_back(std::int64_t const id, coordinate_type const& coordinates);
+
+    /// \return node at the slot
+    node operator[](std::size_t const slot) const noexcept
+    {
+        return {m_ids[slot], m_coordinates[slot]};
+    }
+
+    std::vector<std::int64_t> const& ids() const noexcept { return m_ids; }
+
+    std::vector<std::int64_t>& ids() noexcept { return m_ids; }
+
+    std::vector<coordinate_type> const& coordinates() const noexcept { return m_coordinates; }
+
+    std::vector<coordinate_type>& coordinates() noexcept { return m_coordinates; }
+
+    /// \return the largest node id or zero if there are no nodes
+    std::int64_t max_id() const noexcept { return m_max_id; }
+
+    /// \return lower and upper corners of the box bounding the coordinates
+    std::pair<coordinate_type, coordinate_type> bounding_box() const;
+
+    /// Build the index from the node ids to the slots.  This must be called
+    /// after the ids are modified and before \sa slot or \sa gather
+    void build_index();
+
+    /// \return slot of the node id or -1 if the id is not in the list
+    std::int64_t slot(std::int64_t const id) const noexcept;
+
+    /// Copy the nodes with the given ids into a new list in the same order.
+    /// The index of the new list is not built.
+    /// \param ids Node ids to gather, which are typically sorted
+    /// \param id_offset Offset to apply to the ids of the gathered nodes
+    node_list gather(index_array const& ids, std::int64_t const id_offset = 0) const;
+
+private:
+    std::vector<std::int64_t> m_ids;
+    std::vector<coordinate_type> m_coordinates;
+
+    /// Slot for each id in [m_min_id, m_max_id] when the index is a table,
+    /// otherwise the (id, slot) pairs sorted by id
+    std::vector<std::int64_t> m_slots;
+    std::vector<std::pair<std::int64_t, std::int64_t>> m_sorted_slots;
+
+    std::int64_t m_min_id = 0;
+    std::int64_t m_max_id = 0;
+
+    /// Ids are consecutive and increasing so the slot is the offset from the minimum
+    bool m_is_consecutive = true;
+};
+} // namespace imr
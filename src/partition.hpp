@@ -0,0 +1,137 @@
+
+#pragma once
+
+#include "adjacency.hpp"
+#include "element_group.hpp"
+#include "index_array.hpp"
+#include "node_list.hpp"
+#include "span.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace imr
+{
+/// Nodes shared between a partition and one of its neighbours.  The node
+/// numbers and partition numbers follow the format of \sa distributed
+struct partition_interface
+{
+    /// Owning (master) partition of the interface
+    std::int32_t master;
+
+    /// Sharing (slave) partition of the interface
+    std::int32_t slave;
+
+    /// +1 if the partition is the master of the interface or -1 otherwise
+    std::int32_t value;
+
+    /// Offset of the interface nodes in the numbering of all interface nodes
+    std::int64_t global_start_id;
+
+    /// Global node numbers on the interface
+    std::vector<std::int64_t> node_ids;
+
+    /// Local node numbers of the interface nodes owned by the partition, which
+    /// are sent to the neighbour, in the order of the global node numbers.
+    /// A node is owned by the lowest numbered partition containing it.  This
+    /// is only filled for the interprocess format.
+    std::vector<std::int64_t> send_ids;
+
+    /// Local node numbers of the interface nodes owned by the neighbour, which
+    /// are received from the neighbour, in the order of the global node numbers
+    std::vector<std::int64_t> receive_ids;
+};
+
+/// Elements and nodes owned by neighbouring partitions within a number of
+/// element layers of a partition.  The halo connectivity uses the same
+/// ordering as the partition, where in the local ordering the halo nodes are
+/// numbered after the nodes of the partition.
+struct partition_halo
+{
+    /// Number of element layers in the halo
+    int depth = 0;
+
+    /// Halo elements grouped by physical name and element type
+    std::vector<element_group> element_groups;
+
+    /// Owning partition of each halo element for each element group
+    std::vector<std::vector<std::int32_t>> element_owners;
+
+    /// Layer (starting from one) of each halo element for each element group
+    std::vector<std::vector<std::int32_t>> element_layers;
+
+    /// Halo nodes ordered by global node number
+    node_list nodes;
+
+    /// Owning partition of each halo node
+    std::vector<std::int32_t> node_owners;
+};
+
+/// partition holds the mesh of a single process after the conversion to the
+/// requested ordering and indexing base.  The accessors return views into the
+/// data owned by the partition so the mesh can be used in-process without
+/// serialising it to file.
+class partition
+{
+public:
+    explicit partition(int const number) : m_number(number) {}
+
+    /// \return zero based partition number
+    int number() const noexcept { return m_number; }
+
+    /// \return element groups of the partition
+    span<element_group const> element_groups() const noexcept { return m_element_groups; }
+
+    /// \return mapping from the local node numbers to the global node numbers
+    index_array const& local_to_global() const noexcept { return m_local_to_global; }
+
+    /// \return local nodes in the order of the local to global mapping
+    node_list const& nodes() const noexcept { return m_nodes; }
+
+    /// \return coordinates of the local nodes
+    span<node_list::coordinate_type const> coordinates() const noexcept
+    {
+        return m_nodes.coordinates();
+    }
+
+    /// \return interfaces shared with the neighbouring partitions
+    span<partition_interface const> interfaces() const noexcept { return m_interfaces; }
+
+    /// \return total number of interface nodes over all partitions (FETI format)
+    std::int64_t interface_nodes() const noexcept { return m_interface_nodes; }
+
+    /// \return elements and nodes surrounding the partition \sa partition_options
+    partition_halo const& halo() const noexcept { return m_halo; }
+
+    /// \return elements containing each local node.  The rows are the zero
+    /// based local node numbers and the columns are the zero based element
+    /// numbers over the element groups in order, excluding the skin groups.
+    /// This is empty unless requested \sa partition_options
+    csr_graph const& node_elements() const noexcept { return m_node_elements; }
+
+    /// \return nodes connected to each local node through an element, including
+    /// the node itself, in zero based local node numbers \sa node_elements
+    csr_graph const& nodal_graph() const noexcept { return m_nodal_graph; }
+
+private:
+    friend class mesh_reader;
+
+    std::vector<element_group> m_element_groups;
+
+    index_array m_local_to_global;
+
+    node_list m_nodes;
+
+    std::vector<partition_interface> m_interfaces;
+
+    std::int64_t m_interface_nodes = 0;
+
+    partition_halo m_halo;
+
+    csr_graph m_node_elements;
+
+    csr_graph m_nodal_graph;
+
+    int m_number;
+};
+} // namespace imr
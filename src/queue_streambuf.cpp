@@ -0,0 +1,56 @@
+
+#include "queue_streambuf.hpp"
+
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+namespace imr
+{
+queue_streambuf::int_type queue_streambuf::underflow()
+{
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    do
+    {
+        if (!m_blocks.pop(m_block)) return traits_type::eof();
+    } while (m_block.empty());
+
+    setg(&m_block[0], &m_block[0], &m_block[0] + m_block.size());
+
+    return traits_type::to_int_type(*gptr());
+}
+
+file_reader::file_reader(std::string const& file_name,
+                         bounded_queue<std::string>& blocks,
+                         std::size_t const block_size)
+    : m_blocks(blocks)
+{
+    auto file = std::make_shared<std::ifstream>(file_name, std::ios::in | std::ios::binary);
+
+    if (!file->is_open())
+    {
+        throw std::domain_error("Input file " + file_name + " was not able to be opened");
+    }
+
+    m_thread = std::thread([this, file, block_size] {
+        while (*file)
+        {
+            std::string block(block_size, '\0');
+
+            file->read(&block[0], block_size);
+            block.resize(file->gcount());
+
+            if (block.empty() || !m_blocks.push(std::move(block))) break;
+        }
+        m_blocks.close();
+    });
+}
+
+file_reader::~file_reader()
+{
+    // Release the thread if it is waiting on a full queue
+    m_blocks.close();
+    m_thread.join();
+}
+} // namespace imr
@@ -0,0 +1,58 @@
+
+#pragma once
+
+#include "bounded_queue.hpp"
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+namespace imr
+{
+/// Size of the blocks read from file in the reading stage of the pipeline
+constexpr std::size_t read_block_size = 1 << 20;
+
+/// queue_streambuf is an input stream buffer over the blocks of a queue,
+/// which allows the text of a file to be parsed through a std::istream while
+/// another thread is still reading the file into the queue.
+class queue_streambuf : public std::streambuf
+{
+public:
+    explicit queue_streambuf(bounded_queue<std::string>& blocks) : m_blocks(blocks) {}
+
+protected:
+    /// Move to the next block from the queue once the current block is consumed
+    int_type underflow() override;
+
+private:
+    bounded_queue<std::string>& m_blocks;
+
+    /// Block that is currently being read
+    std::string m_block;
+};
+
+/// file_reader reads a file into a queue of blocks on a background thread.
+/// The queue is closed when the end of the file is reached.
+class file_reader
+{
+public:
+    /// \param file_name Name of the file to read, which is opened before returning
+    /// \param blocks Queue to fill with the contents of the file
+    /// \param block_size Number of bytes in each block
+    file_reader(std::string const& file_name,
+                bounded_queue<std::string>& blocks,
+                std::size_t const block_size = read_block_size);
+
+    /// Stop reading and wait for the thread to finish
+    ~file_reader();
+
+    file_reader(file_reader const&) = delete;
+    file_reader& operator=(file_reader const&) = delete;
+
+private:
+    bounded_queue<std::string>& m_blocks;
+
+    std::thread m_thread;
+};
+} // namespace imr
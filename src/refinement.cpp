@@ -0,0 +1,78 @@
+
+#include "refinement.hpp"
+
+#include "mesh_reader.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace imr
+{
+refinement_template const& element_refinement(int const type_id)
+{
+    static refinement_template const point = {{}, {{0}}};
+
+    static refinement_template const line2 = {{{0, 1}}, {{0, 2}, {2, 1}}};
+
+    static refinement_template const triangle3 = {{{0, 1}, {1, 2}, {2, 0}},
+                                                  {{0, 3, 5}, {3, 1, 4}, {5, 4, 2}, {3, 4, 5}}};
+
+    static refinement_template const quadrilateral4 =
+        {{{0, 1}, {1, 2}, {2, 3}, {3, 0}, {0, 1, 2, 3}},
+         {{0, 4, 8, 7}, {4, 1, 5, 8}, {8, 5, 2, 6}, {7, 8, 6, 3}}};
+
+    // The octahedron left after cutting the corners is split along 2-0 to 1-3
+    static refinement_template const tetrahedron4 =
+        {{{0, 1}, {1, 2}, {2, 0}, {3, 0}, {3, 2}, {3, 1}},
+         {{0, 4, 6, 7},
+          {4, 1, 5, 9},
+          {6, 5, 2, 8},
+          {7, 9, 8, 3},
+          {6, 9, 4, 5},
+          {6, 9, 5, 8},
+          {6, 9, 8, 7},
+          {6, 9, 7, 4}}};
+
+    static refinement_template const hexahedron8 = {{{0, 1},
+                                                     {0, 3},
+                                                     {0, 4},
+                                                     {1, 2},
+                                                     {1, 5},
+                                                     {2, 3},
+                                                     {2, 6},
+                                                     {3, 7},
+                                                     {4, 5},
+                                                     {4, 7},
+                                                     {5, 6},
+                                                     {6, 7},
+                                                     {0, 1, 2, 3},
+                                                     {0, 1, 4, 5},
+                                                     {0, 3, 4, 7},
+                                                     {1, 2, 5, 6},
+                                                     {2, 3, 6, 7},
+                                                     {4, 5, 6, 7},
+                                                     {0, 1, 2, 3, 4, 5, 6, 7}},
+                                                    {{0, 8, 20, 9, 10, 21, 26, 22},
+                                                     {8, 1, 11, 20, 21, 12, 23, 26},
+                                                     {20, 11, 2, 13, 26, 23, 14, 24},
+                                                     {9, 20, 13, 3, 22, 26, 24, 15},
+                                                     {10, 21, 26, 22, 4, 16, 25, 17},
+                                                     {21, 12, 23, 26, 16, 5, 18, 25},
+                                                     {26, 23, 14, 24, 25, 18, 6, 19},
+                                                     {22, 26, 24, 15, 17, 25, 19, 7}}};
+
+    switch (type_id)
+    {
+        case POINT: return point;
+        case LINE2: return line2;
+        case TRIANGLE3: return triangle3;
+        case QUADRILATERAL4: return quadrilateral4;
+        case TETRAHEDRON4: return tetrahedron4;
+        case HEXAHEDRON8: return hexahedron8;
+        default:
+            throw std::domain_error("Refinement of the elementTypeId " + std::to_string(type_id) +
+                                    " is not implemented");
+    }
+    return point;
+}
+} // namespace imr
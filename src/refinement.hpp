@@ -0,0 +1,25 @@
+
+#pragma once
+
+#include <vector>
+
+namespace imr
+{
+/// Uniform refinement of an element into children of the same type.  The
+/// local nodes of the refined element are the nodes of the parent followed
+/// by the new nodes, where each new node is placed at the centre of a set of
+/// parent nodes (an edge, a face or the element itself).  The new nodes
+/// follow the ordering of the second order Gmsh element of the same shape.
+struct refinement_template
+{
+    /// Parent local nodes defining each new node
+    std::vector<std::vector<int>> new_nodes;
+
+    /// Local nodes of each child in the Gmsh ordering of the element type
+    std::vector<std::vector<int>> children;
+};
+
+/// \return the refinement of an element type, which throws std::domain_error
+/// for element types without a refinement
+refinement_template const& element_refinement(int const type_id);
+} // namespace imr
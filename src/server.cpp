@@ -0,0 +1,255 @@
+
+#include "server.hpp"
+
+#include "command_line.hpp"
+#include "mesh_cache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace imr
+{
+namespace
+{
+/// Seconds a client may wait between requests, or take to receive a response,
+/// before the connection is closed so other clients are served
+constexpr int idle_timeout = 10;
+
+/// Remove a socket left behind by a server that is no longer running
+/// \throw if the path is not a socket or a server is listening on it
+void remove_stale_socket(std::string const& socket_path, sockaddr_un const& address)
+{
+    struct stat status;
+
+    if (::lstat(socket_path.c_str(), &status) != 0) return;
+
+    if (!S_ISSOCK(status.st_mode))
+    {
+        throw std::domain_error("The socket path " + socket_path + " exists and is not a socket");
+    }
+
+    auto const client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    auto const is_listening =
+        client >= 0 &&
+        ::connect(client, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0;
+
+    if (client >= 0) ::close(client);
+
+    if (is_listening)
+    {
+        throw std::runtime_error("A server is already listening on the socket " + socket_path);
+    }
+    ::unlink(socket_path.c_str());
+}
+
+/// Send the complete response to the client
+void send_all(int const client, std::string const& response)
+{
+    for (std::size_t sent = 0; sent < response.size();)
+    {
+        auto const bytes = ::send(client,
+                                  response.data() + sent,
+                                  response.size() - sent,
+                                  MSG_NOSIGNAL);
+
+        if (bytes < 0) throw std::runtime_error("The response could not be sent");
+
+        sent += bytes;
+    }
+}
+
+/// \return the parsed mesh of a single input file in the requested format
+std::shared_ptr<mesh_reader> cached_reader(mesh_cache& cache,
+                                           conversion_settings const& settings,
+                                           std::string const& input)
+{
+    auto reader = cache.get(input, settings.refinement_levels, settings.merge_tolerance);
+
+    reader->set_format(settings.ordering, settings.indexing, settings.format);
+    reader->set_interface_detection(settings.interfaces);
+    reader->set_partition_options(settings.contents);
+
+    return reader;
+}
+
+/// Process a single request
+/// \param is_running Set to false for a shutdown request
+/// \return response to the request
+std::string respond(mesh_cache& cache, std::string const& request, bool& is_running)
+{
+    std::istringstream tokens(request);
+
+    std::vector<std::string> arguments{std::istream_iterator<std::string>(tokens),
+                                       std::istream_iterator<std::string>()};
+
+    if (arguments.empty()) throw std::domain_error("Empty request");
+
+    auto const command = arguments.front();
+
+    auto const start = std::chrono::high_resolution_clock::now();
+
+    if (command == "shutdown")
+    {
+        is_running = false;
+        return "ok\n";
+    }
+    else if (command == "convert")
+    {
+        auto const settings = parse_conversion({begin(arguments) + 1, end(arguments)});
+
+        if (settings.input_files.empty()) throw std::domain_error("Missing input file");
+
+        for (auto const& input : settings.input_files)
+        {
+            cached_reader(cache, settings, input)->write(settings.output);
+        }
+
+        std::chrono::duration<double, std::milli> const elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+
+        return "ok " + std::to_string(elapsed.count()) + "\n";
+    }
+    else if (command == "partition")
+    {
+        if (arguments.size() < 2) throw std::domain_error("Missing partition number");
+
+        auto const partition_number = std::stoi(arguments[1]);
+
+        auto const settings = parse_conversion({begin(arguments) + 2, end(arguments)});
+
+        if (settings.input_files.size() != 1)
+        {
+            throw std::domain_error("A partition request needs a single input file");
+        }
+
+        auto const contents = cached_reader(cache, settings, settings.input_files.front())
+                                  ->write_partition(partition_number, settings.output);
+
+        return "ok " + std::to_string(contents.size()) + "\n" + contents;
+    }
+    throw std::domain_error("Unknown command " + command);
+}
+
+/// Respond to each line received from a client until the connection is closed
+void serve_client(int const client, mesh_cache& cache, bool& is_running)
+{
+    std::string buffer;
+
+    char block[4096];
+
+    while (is_running)
+    {
+        auto const bytes = ::recv(client, block, sizeof(block), 0);
+
+        if (bytes <= 0) return;
+
+        buffer.append(block, bytes);
+
+        std::size_t end_of_line;
+
+        while (is_running && (end_of_line = buffer.find('\n')) != std::string::npos)
+        {
+            auto const request = buffer.substr(0, end_of_line);
+            buffer.erase(0, end_of_line + 1);
+
+            std::string response;
+            try
+            {
+                response = respond(cache, request, is_running);
+            }
+            catch (std::exception const& error)
+            {
+                std::string message = error.what();
+                std::replace(begin(message), end(message), '\n', ' ');
+
+                response = "error " + message + "\n";
+            }
+            send_all(client, response);
+        }
+    }
+}
+}
+
+void serve(std::string const& socket_path, std::size_t const cache_size)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::domain_error("The socket path " + socket_path + " is too long");
+    }
+    std::copy(begin(socket_path), end(socket_path), address.sun_path);
+
+    remove_stale_socket(socket_path, address);
+
+    auto const listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener < 0 ||
+        ::bind(listener, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 16) != 0)
+    {
+        if (listener >= 0) ::close(listener);
+
+        throw std::runtime_error("Unable to listen on the socket " + socket_path);
+    }
+
+    // Identify the socket created so only this socket is removed on shutdown
+    struct stat created;
+    ::lstat(socket_path.c_str(), &created);
+
+    std::cout << "Serving conversion requests on " << socket_path << std::endl;
+
+    mesh_cache cache(cache_size);
+
+    bool is_running = true;
+
+    // Requests are processed one at a time, where each conversion is parallel
+    while (is_running)
+    {
+        auto const client = ::accept(listener, nullptr, nullptr);
+
+        if (client < 0) continue;
+
+        // A client that neither sends nor closes would otherwise block
+        // every other client, so receiving and sending time out
+        timeval timeout{};
+        timeout.tv_sec = idle_timeout;
+
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        try
+        {
+            serve_client(client, cache, is_running);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << error.what() << std::endl;
+        }
+        ::close(client);
+    }
+
+    ::close(listener);
+
+    struct stat status;
+
+    if (::lstat(socket_path.c_str(), &status) == 0 && status.st_dev == created.st_dev &&
+        status.st_ino == created.st_ino)
+    {
+        ::unlink(socket_path.c_str());
+    }
+}
+} // namespace imr
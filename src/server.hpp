@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace imr
+{
+/// Serve conversion requests on a Unix socket until a shutdown request is
+/// received.  The parsed meshes are kept in a \sa mesh_cache so repeated
+/// requests for the same mesh do not parse the file again.  Each request is a
+/// single line holding a command followed by the command line options and
+/// the input file, and each response starts with a line "ok ..." or
+/// "error <message>".
+///
+/// | Request                                    | Response                      |
+/// | :----------------------------------------- | :---------------------------- |
+/// | convert [options] file.msh ...              | ok <milliseconds>             |
+/// | partition <number> [options] file.msh       | ok <bytes> then the contents  |
+/// | shutdown                                    | ok                            |
+///
+/// \param socket_path Path of the socket, which replaces a socket left behind
+///        by a server that is no longer running
+/// \param cache_size Maximum number of parsed meshes to keep in memory
+void serve(std::string const& socket_path, std::size_t const cache_size);
+} // namespace imr
@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <cstddef>
+
+namespace imr
+{
+/// span is a non-owning view over a contiguous sequence of objects
+template <typename T>
+class span
+{
+public:
+    using value_type = T;
+    using iterator   = T*;
+
+public:
+    span() = default;
+
+    span(T* const data, std::size_t const size) noexcept : m_data(data), m_size(size) {}
+
+    /// Construct from a contiguous container with data() and size()
+    template <typename Container>
+    span(Container& container) noexcept : m_data(container.data()), m_size(container.size())
+    {
+    }
+
+    T* data() const noexcept { return m_data; }
+
+    std::size_t size() const noexcept { return m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    T& operator[](std::size_t const i) const noexcept { return m_data[i]; }
+
+    iterator begin() const noexcept { return m_data; }
+
+    iterator end() const noexcept { return m_data + m_size; }
+
+    /// \return view of count elements starting from offset
+    span subspan(std::size_t const offset, std::size_t const count) const noexcept
+    {
+        return {m_data + offset, count};
+    }
+
+private:
+    T* m_data          = nullptr;
+    std::size_t m_size = 0;
+};
+} // namespace imr
@@ -0,0 +1,115 @@
+
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include <json/json.h>
+
+namespace imr
+{
+namespace
+{
+/// \return ratio of the maximum to the mean of a quantity over the partitions
+template <typename Function>
+double imbalance(std::vector<partition_statistics> const& partitions, Function&& quantity)
+{
+    double maximum = 0.0, sum = 0.0;
+
+    for (auto const& partition : partitions)
+    {
+        auto const value = static_cast<double>(quantity(partition));
+
+        maximum = std::max(maximum, value);
+        sum += value;
+    }
+    return sum > 0.0 ? maximum * partitions.size() / sum : 1.0;
+}
+}
+
+double element_cost(int const nodes_per_element)
+{
+    return static_cast<double>(nodes_per_element) * nodes_per_element;
+}
+
+mesh_statistics summarise(std::vector<partition_statistics> partitions)
+{
+    mesh_statistics statistics;
+
+    statistics.partitions = std::move(partitions);
+
+    auto const& all = statistics.partitions;
+
+    // Each cut face is counted by the partitions on both sides
+    for (auto const& partition : all) statistics.edge_cut += partition.cut_faces;
+    statistics.edge_cut /= 2;
+
+    statistics.element_imbalance = imbalance(all, [](auto const& p) { return p.elements; });
+    statistics.cost_imbalance    = imbalance(all, [](auto const& p) { return p.cost; });
+    statistics.node_imbalance    = imbalance(all, [](auto const& p) { return p.nodes; });
+    statistics.interface_imbalance = imbalance(all,
+                                               [](auto const& p) { return p.interface_nodes; });
+
+    return statistics;
+}
+
+std::string format_table(mesh_statistics const& statistics)
+{
+    std::ostringstream table;
+
+    table << std::setw(11) << "Partition" << std::setw(12) << "Elements" << std::setw(14) << "Cost"
+          << std::setw(12) << "Nodes" << std::setw(12) << "Interface" << std::setw(12)
+          << "Neighbours" << std::setw(12) << "Cut faces"
+          << "\n";
+
+    for (auto const& partition : statistics.partitions)
+    {
+        table << std::setw(11) << partition.number << std::setw(12) << partition.elements
+              << std::setw(14) << std::fixed << std::setprecision(0) << partition.cost
+              << std::setw(12) << partition.nodes << std::setw(12) << partition.interface_nodes
+              << std::setw(12) << partition.neighbours << std::setw(12) << partition.cut_faces
+              << "\n";
+    }
+
+    table << "\n  Edge cut " << statistics.edge_cut << "\n"
+          << "  Imbalance (maximum / mean) " << std::setprecision(3) << "elements "
+          << statistics.element_imbalance << ", cost " << statistics.cost_imbalance
+          << ", nodes " << statistics.node_imbalance << ", interface nodes "
+          << statistics.interface_imbalance << "\n";
+
+    return table.str();
+}
+
+std::string format_json(mesh_statistics const& statistics)
+{
+    Json::Value event;
+
+    for (auto const& partition : statistics.partitions)
+    {
+        Json::Value entry;
+
+        entry["Partition"]      = partition.number;
+        entry["Elements"]       = Json::Int64(partition.elements);
+        entry["Cost"]           = partition.cost;
+        entry["Nodes"]          = Json::Int64(partition.nodes);
+        entry["InterfaceNodes"] = Json::Int64(partition.interface_nodes);
+        entry["Neighbours"]     = partition.neighbours;
+        entry["CutFaces"]       = Json::Int64(partition.cut_faces);
+
+        event["Partitions"].append(entry);
+    }
+
+    event["EdgeCut"] = Json::Int64(statistics.edge_cut);
+
+    auto& imbalance = event["Imbalance"];
+
+    imbalance["Elements"]       = statistics.element_imbalance;
+    imbalance["Cost"]           = statistics.cost_imbalance;
+    imbalance["Nodes"]          = statistics.node_imbalance;
+    imbalance["InterfaceNodes"] = statistics.interface_imbalance;
+
+    Json::StyledWriter jsonwriter;
+    return jsonwriter.write(event);
+}
+} // namespace imr
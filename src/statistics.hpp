@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// \file statistics.hpp
+/// Diagnostics of the quality of a decomposition.  The elements counted are
+/// those of the highest dimension in the mesh, weighted by the square of the
+/// number of nodes of the element as an estimate of the assembly cost.  The
+/// imbalance of a quantity is the ratio of its maximum to its mean over the
+/// partitions, so a perfectly balanced decomposition has an imbalance of one.
+
+namespace imr
+{
+/// Size of a single partition and of its interfaces
+struct partition_statistics
+{
+    /// Zero based partition number
+    int number = 0;
+
+    /// Number of elements of the highest dimension
+    std::int64_t elements = 0;
+
+    /// Elements weighted by their cost \sa element_cost
+    double cost = 0.0;
+
+    /// Number of nodes of the partition
+    std::int64_t nodes = 0;
+
+    /// Number of nodes shared with other partitions
+    std::int64_t interface_nodes = 0;
+
+    /// Number of partitions sharing a node with the partition
+    std::int32_t neighbours = 0;
+
+    /// Number of element faces shared with elements of other partitions
+    std::int64_t cut_faces = 0;
+};
+
+/// Statistics of every partition and the imbalance of the decomposition
+struct mesh_statistics
+{
+    std::vector<partition_statistics> partitions;
+
+    /// Number of element faces between elements of different partitions,
+    /// which is the edge cut of the dual graph of the mesh
+    std::int64_t edge_cut = 0;
+
+    double element_imbalance = 1.0;
+    double cost_imbalance = 1.0;
+    double node_imbalance = 1.0;
+    double interface_imbalance = 1.0;
+};
+
+/// \return estimated assembly cost of an element, which is the size of the
+/// element matrix given by the square of the number of nodes
+double element_cost(int const nodes_per_element);
+
+/// Compute the edge cut and the imbalance ratios of the partitions
+mesh_statistics summarise(std::vector<partition_statistics> partitions);
+
+/// \return a table of the statistics for printing
+std::string format_table(mesh_statistics const& statistics);
+
+/// \return JSON representation of the statistics
+std::string format_json(mesh_statistics const& statistics);
+} // namespace imr
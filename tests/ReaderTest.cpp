@@ -1,8 +1,24 @@
 #define CATCH_CONFIG_MAIN
 
+#include "adjacency.hpp"
+#include "block_compression.hpp"
+#include "container.hpp"
+#include "index_transform.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_index.hpp"
 #include "mesh_reader.hpp"
+#include "queue_streambuf.hpp"
+#include "refinement.hpp"
 
 #include <catch2/catch.hpp>
+#include <json/json.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 using namespace imr;
 
@@ -69,6 +85,432 @@ TEST_CASE("Tests for decomposed ElementData")
     REQUIRE(elementData.isOwnedByProcess(3));
     REQUIRE(elementData.maxProcessId() == 4);
 }
+TEST_CASE("Tests for index transforms")
+{
+    std::vector<std::int64_t> indices{7, 3, 5, 3, 9};
+
+    SECTION("Shift indices to zero based")
+    {
+        shift_indices(indices.data(), indices.data() + indices.size(), -1);
+
+        REQUIRE(indices == std::vector<std::int64_t>{6, 2, 4, 2, 8});
+    }
+    SECTION("Renumber indices through a lookup table")
+    {
+        // Lookup table starting at index 3 mapping {3, 5, 7, 9} to {0, 1, 2, 3}
+        std::vector<std::int64_t> const lookup{0, -1, 1, -1, 2, -1, 3};
+
+        renumber_indices(indices.data(), indices.data() + indices.size(), lookup.data(), 3);
+
+        REQUIRE(indices == std::vector<std::int64_t>{2, 0, 1, 0, 3});
+    }
+}
+TEST_CASE("Tests for index_array")
+{
+    std::vector<std::int64_t> const indices{402, 233, 450, 197};
+
+    REQUIRE(index_array::fits_narrow(std::numeric_limits<std::int32_t>::max()));
+    REQUIRE(!index_array::fits_narrow(std::int64_t(1) << 32));
+
+    SECTION("Narrow storage")
+    {
+        index_array narrow(true);
+        narrow.append(begin(indices), end(indices));
+
+        REQUIRE(narrow.is_narrow());
+        REQUIRE(narrow.size() == indices.size());
+
+        shift_indices(narrow.data<std::int32_t>(), narrow.data<std::int32_t>() + narrow.size(), -1);
+
+        for (std::size_t i = 0; i < indices.size(); ++i)
+        {
+            REQUIRE(narrow[i] == indices[i] - 1);
+        }
+    }
+    SECTION("Wide storage")
+    {
+        index_array wide(false);
+        wide.append(begin(indices), end(indices));
+
+        REQUIRE(!wide.is_narrow());
+        REQUIRE(wide.front() == 402);
+        REQUIRE(wide.back() == 197);
+
+        index_array copy(true);
+        copy.append(wide);
+
+        REQUIRE(copy.visit([](auto const first, auto const last) {
+            return static_cast<std::size_t>(std::distance(first, last));
+        }) == indices.size());
+    }
+}
+TEST_CASE("Tests for block compression")
+{
+    std::string data;
+    for (int i = 0; i < 1000; ++i)
+    {
+        data += "[" + std::to_string(i) + ", " + std::to_string(i + 1) + "],\n";
+    }
+
+    auto const compressed = compress_blocks(data, 6, 1024);
+
+    auto const index = block_index(compressed.data(), compressed.size());
+
+    REQUIRE(index.size() == (data.size() + 1023) / 1024);
+    REQUIRE(compressed.size() < data.size());
+
+    SECTION("Decompress a single block")
+    {
+        auto const& block = index[3];
+
+        REQUIRE(block.uncompressed_size == 1024);
+        REQUIRE(decompress_block(compressed.data() + block.offset, block.size) ==
+                data.substr(3 * 1024, 1024));
+    }
+    SECTION("Decompress the stream")
+    {
+        REQUIRE(decompress_blocks(compressed) == data);
+    }
+    SECTION("Detect corrupt data")
+    {
+        REQUIRE_THROWS_AS(block_index(data.data(), data.size()), std::runtime_error);
+    }
+}
+TEST_CASE("Tests for node_list")
+{
+    node_list nodes;
+    nodes.push_back(7, {{0.0, 0.0, 0.0}});
+    nodes.push_back(3, {{1.0, 0.0, 0.0}});
+    nodes.push_back(5, {{1.0, 1.0, 0.0}});
+
+    SECTION("Table index for dense ids")
+    {
+        nodes.build_index();
+
+        REQUIRE(nodes.max_id() == 7);
+        REQUIRE(nodes.slot(3) == 1);
+        REQUIRE(nodes.slot(5) == 2);
+        REQUIRE(nodes.slot(4) == -1);
+        REQUIRE(nodes.slot(8) == -1);
+    }
+    SECTION("Sorted index for sparse ids")
+    {
+        nodes.push_back(1000, {{0.0, 1.0, 0.0}});
+        nodes.build_index();
+
+        REQUIRE(nodes.slot(1000) == 3);
+        REQUIRE(nodes.slot(7) == 0);
+        REQUIRE(nodes.slot(999) == -1);
+
+        index_array ids(true);
+        std::vector<std::int64_t> const local_ids{3, 1000};
+        ids.append(begin(local_ids), end(local_ids));
+
+        auto const gathered = nodes.gather(ids, -1);
+
+        REQUIRE(gathered.size() == 2);
+        REQUIRE(gathered[0].id == 2);
+        REQUIRE(gathered[1].id == 999);
+        REQUIRE(gathered[1].coordinates[1] == Approx(1.0));
+    }
+    SECTION("Missing nodes")
+    {
+        nodes.build_index();
+
+        index_array ids;
+        std::vector<std::int64_t> const local_ids{3, 4};
+        ids.append(begin(local_ids), end(local_ids));
+
+        REQUIRE_THROWS_AS(nodes.gather(ids), std::domain_error);
+    }
+}
+TEST_CASE("Tests for sparse node numbering")
+{
+    {
+        std::ofstream file("sparse.msh");
+        file << "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n"
+             << "$PhysicalNames\n1\n2 1 \"domain\"\n$EndPhysicalNames\n"
+             << "$Nodes\n4\n100 0 0 0\n20 1 0 0\n3000 1 1 0\n4 0 1 0\n$EndNodes\n"
+             << "$Elements\n1\n1 3 2 1 1 100 20 3000 4\n$EndElements\n";
+    }
+
+    mesh_reader reader("sparse.msh", NodalOrdering::Local, IndexingBase::One, distributed::feti);
+
+    REQUIRE(reader.nodes().size() == 4);
+    REQUIRE(reader.nodes().slot(3000) == 2);
+
+    reader.write(true);
+
+    std::ifstream file("sparse.mesh");
+    Json::Value mesh;
+    file >> mesh;
+
+    auto const& nodes = mesh["Nodes"][0];
+
+    // Local nodes are ordered by the global node id
+    REQUIRE(nodes["Indices"][0].asInt() == 4);
+    REQUIRE(nodes["Indices"][3].asInt() == 3000);
+    REQUIRE(nodes["Coordinates"][3][1].asDouble() == Approx(1.0));
+
+    auto const& connectivity = mesh["Elements"][0]["NodalConnectivity"][0];
+
+    REQUIRE(connectivity[0].asInt() == 3);
+    REQUIRE(connectivity[2].asInt() == 4);
+
+    std::remove("sparse.msh");
+    std::remove("sparse.mesh");
+}
+TEST_CASE("Tests for in-process partitions")
+{
+    mesh_reader reader("decomposed.msh",
+                       NodalOrdering::Local,
+                       IndexingBase::Zero,
+                       distributed::interprocess);
+
+    auto const local = reader.local_mesh(2);
+
+    REQUIRE(local == reader.local_mesh(2));
+    REQUIRE(local->number() == 2);
+
+    // Each partition holds a single quadrilateral
+    REQUIRE(local->element_groups().size() == 1);
+
+    auto const& group = local->element_groups()[0];
+
+    REQUIRE(group.name == "domain");
+    REQUIRE(group.type_id == QUADRILATERAL4);
+    REQUIRE(group.size() == 1);
+    REQUIRE(group.node_indices.is_narrow());
+    REQUIRE(group.node_indices.narrow().size() == 4);
+    REQUIRE(group.node_indices.wide().empty());
+
+    REQUIRE(local->coordinates().size() == 4);
+    REQUIRE(local->local_to_global().size() == 4);
+
+    // The local connectivity maps back to the global connectivity 9 6 3 7
+    std::vector<std::int64_t> global_connectivity;
+    for (auto const local_node : group.node_indices.narrow())
+    {
+        global_connectivity.push_back(local->local_to_global()[local_node] + 1);
+    }
+    REQUIRE(global_connectivity == std::vector<std::int64_t>{9, 6, 3, 7});
+
+    // The coordinate view refers to the local nodes
+    REQUIRE(local->coordinates()[1][0] == Approx(1.0));
+
+    REQUIRE(!local->interfaces().empty());
+
+    REQUIRE_THROWS_AS(reader.local_mesh(4), std::out_of_range);
+}
+TEST_CASE("Tests for halo layers")
+{
+    mesh_reader reader("decomposed.msh",
+                       NodalOrdering::Local,
+                       IndexingBase::Zero,
+                       distributed::feti);
+
+    REQUIRE(reader.local_mesh(0)->halo().depth == 0);
+    REQUIRE(reader.local_mesh(0)->halo().element_groups.empty());
+
+    partition_options options;
+    options.halo_depth = 1;
+    reader.set_partition_options(options);
+
+    // Partition 0 holds the element 5 2 6 9 and every other element shares node 9
+    auto const& halo = reader.local_mesh(0)->halo();
+
+    REQUIRE(halo.depth == 1);
+    REQUIRE(halo.element_groups.size() == 1);
+    REQUIRE(halo.element_groups[0].size() == 3);
+    REQUIRE(halo.element_owners[0] == std::vector<std::int32_t>{1, 3, 2});
+    REQUIRE(halo.element_layers[0] == std::vector<std::int32_t>{1, 1, 1});
+
+    // Halo nodes 1 3 4 7 8 are numbered after the local nodes 2 5 6 9
+    REQUIRE(halo.nodes.size() == 5);
+    REQUIRE(halo.nodes.ids() == std::vector<std::int64_t>{0, 2, 3, 6, 7});
+    REQUIRE(halo.node_owners.size() == 5);
+
+    // Element 1 (1 5 9 8) in local ordering
+    auto const& connectivity = halo.element_groups[0].node_indices;
+    REQUIRE(connectivity[0] == 4);
+    REQUIRE(connectivity[1] == 1);
+    REQUIRE(connectivity[2] == 3);
+    REQUIRE(connectivity[3] == 8);
+
+    SECTION("Deeper halos are limited by the mesh")
+    {
+        options.halo_depth = 3;
+        reader.set_partition_options(options);
+
+        REQUIRE(reader.local_mesh(0)->halo().element_groups[0].size() == 3);
+    }
+}
+TEST_CASE("Tests for boundary skin")
+{
+    mesh_reader reader("decomposed.msh",
+                       NodalOrdering::Global,
+                       IndexingBase::Zero,
+                       distributed::feti);
+
+    REQUIRE(reader.local_mesh(0)->element_groups().size() == 1);
+
+    partition_options options;
+    options.skin = true;
+    reader.set_partition_options(options);
+
+    // Partition 0 holds the element 5 2 6 9 where the edges 5 2 and 2 6 are on
+    // the exterior and the edges 6 9 and 9 5 are shared with other partitions
+    auto const groups = reader.local_mesh(0)->element_groups();
+
+    REQUIRE(groups.size() == 3);
+
+    REQUIRE(groups[1].name == "skin_exterior");
+    REQUIRE(groups[1].type_id == LINE2);
+    REQUIRE(groups[1].ids == std::vector<int>{2, 2});
+    REQUIRE(groups[1].node_indices.size() == 4);
+    REQUIRE(groups[1].node_indices[0] == 4);
+    REQUIRE(groups[1].node_indices[1] == 1);
+    REQUIRE(groups[1].node_indices[2] == 1);
+    REQUIRE(groups[1].node_indices[3] == 5);
+
+    REQUIRE(groups[2].name == "skin_interface");
+    REQUIRE(groups[2].type_id == LINE2);
+    REQUIRE(groups[2].size() == 2);
+    REQUIRE(groups[2].node_indices[0] == 5);
+    REQUIRE(groups[2].node_indices[1] == 8);
+    REQUIRE(groups[2].node_indices[2] == 8);
+    REQUIRE(groups[2].node_indices[3] == 4);
+
+    // Every partition holds a single quadrilateral in a corner of the square
+    for (int partition = 1; partition < reader.numberOfPartitions(); ++partition)
+    {
+        auto const local_groups = reader.local_mesh(partition)->element_groups();
+
+        REQUIRE(local_groups.size() == 3);
+        REQUIRE(local_groups[1].size() == 2);
+        REQUIRE(local_groups[2].size() == 2);
+    }
+}
+TEST_CASE("Tests for adjacency graphs")
+{
+    // Two triangles sharing the edge between nodes 1 and 2
+    csr_graph element_nodes;
+    element_nodes.offsets = {0, 3, 6};
+    element_nodes.indices = {0, 1, 2, 1, 3, 2};
+
+    auto const node_elements = transpose(element_nodes, 4);
+
+    REQUIRE(node_elements.offsets == std::vector<std::int64_t>{0, 1, 3, 5, 6});
+    REQUIRE(node_elements.indices == std::vector<std::int64_t>{0, 0, 1, 0, 1, 1});
+
+    auto const nodal_graph = node_graph(element_nodes, node_elements);
+
+    REQUIRE(nodal_graph.offsets == std::vector<std::int64_t>{0, 3, 7, 11, 14});
+    REQUIRE(nodal_graph.indices ==
+            std::vector<std::int64_t>{0, 1, 2, 0, 1, 2, 3, 0, 1, 2, 3, 1, 2, 3});
+
+    SECTION("Partition graphs")
+    {
+        mesh_reader reader("decomposed.msh",
+                           NodalOrdering::Global,
+                           IndexingBase::One,
+                           distributed::feti);
+
+        REQUIRE(reader.local_mesh(0)->nodal_graph().rows() == 0);
+
+        partition_options options;
+        options.adjacency = true;
+        reader.set_partition_options(options);
+
+        // The local nodes of the single quadrilateral are all connected
+        auto const local = reader.local_mesh(0);
+
+        REQUIRE(local->node_elements().offsets == std::vector<std::int64_t>{0, 1, 2, 3, 4});
+        REQUIRE(local->node_elements().indices == std::vector<std::int64_t>{0, 0, 0, 0});
+
+        REQUIRE(local->nodal_graph().rows() == 4);
+        for (std::size_t node = 0; node < local->nodal_graph().rows(); ++node)
+        {
+            REQUIRE(local->nodal_graph().row(node).size() == 4);
+        }
+
+        // The numbering of the graphs is recorded with the global connectivity
+        Json::Value event;
+        Json::Reader().parse(reader.write_partition(0, output_options()), event);
+
+        for (auto const graph : {"NodeToElement", "NodalGraph"})
+        {
+            REQUIRE(event[graph]["Ordering"].asString() == "Local");
+            REQUIRE(event[graph]["IndexBase"].asInt() == 0);
+        }
+    }
+}
+TEST_CASE("Tests for element colouring")
+{
+    SECTION("Colouring graph")
+    {
+        // A strip of three triangles where each shares an edge with the next
+        csr_graph element_nodes;
+        element_nodes.offsets = {0, 3, 6, 9};
+        element_nodes.indices = {0, 1, 2, 1, 3, 2, 2, 3, 4};
+
+        auto const colours = colour_elements(element_nodes, transpose(element_nodes, 5));
+
+        REQUIRE(colours == std::vector<std::int32_t>{0, 1, 2});
+    }
+    SECTION("Coloured element groups")
+    {
+        mesh_reader reader("basic.msh",
+                           NodalOrdering::Global,
+                           IndexingBase::One,
+                           distributed::feti);
+
+        auto const uncoloured = reader.local_mesh(0)->element_groups();
+
+        std::vector<std::vector<int>> ids;
+        for (auto const& group : uncoloured)
+        {
+            REQUIRE(group.colour_offsets.empty());
+            ids.push_back(group.ids);
+        }
+
+        partition_options options;
+        options.colour = true;
+        reader.set_partition_options(options);
+
+        auto const groups = reader.local_mesh(0)->element_groups();
+
+        REQUIRE(groups.size() == ids.size());
+
+        for (std::size_t i = 0; i < groups.size(); ++i)
+        {
+            auto const& group = groups[i];
+
+            REQUIRE(group.colour_offsets.size() > 1);
+            REQUIRE(group.colour_offsets.back() == static_cast<std::int64_t>(group.size()));
+
+            // The elements are a permutation of the uncoloured elements
+            auto sorted_ids = group.ids;
+            std::sort(begin(sorted_ids), end(sorted_ids));
+            std::sort(begin(ids[i]), end(ids[i]));
+            REQUIRE(sorted_ids == ids[i]);
+
+            // No node appears twice within a colour
+            for (std::size_t colour = 0; colour + 1 < group.colour_offsets.size(); ++colour)
+            {
+                std::vector<std::int64_t> nodes;
+                for (auto position = group.colour_offsets[colour] * group.nodes_per_element;
+                     position < group.colour_offsets[colour + 1] * group.nodes_per_element;
+                     ++position)
+                {
+                    nodes.push_back(group.node_indices[position]);
+                }
+                std::sort(begin(nodes), end(nodes));
+                REQUIRE(std::adjacent_find(begin(nodes), end(nodes)) == end(nodes));
+            }
+        }
+    }
+}
 TEST_CASE("Tests for Reader")
 {
     mesh_reader reader("decomposed.msh",
@@ -89,3 +531,724 @@ TEST_CASE("Tests for Reader")
 
     reader.write(false);
 }
+TEST_CASE("Tests for single file output")
+{
+    mesh_reader reader("decomposed.msh",
+                       NodalOrdering::Local,
+                       IndexingBase::Zero,
+                       distributed::feti);
+
+    output_options options;
+    options.print_indices = false;
+
+    reader.write(options);
+
+    options.single_file = true;
+
+    SECTION("Uncompressed container")
+    {
+        reader.write(options);
+
+        container_reader container("decomposed.meshes");
+
+        REQUIRE(container.partitions() == 4);
+        REQUIRE(!container.is_compressed());
+
+        for (std::size_t partition = 0; partition < container.partitions(); ++partition)
+        {
+            std::ifstream file("decomposed.mesh" + std::to_string(partition));
+            std::stringstream contents;
+            contents << file.rdbuf();
+
+            REQUIRE(container.read(partition) == contents.str());
+        }
+        REQUIRE_THROWS_AS(container.read(4), std::out_of_range);
+    }
+    SECTION("Compressed container")
+    {
+        options.compress = true;
+
+        reader.write(options);
+
+        container_reader container("decomposed.meshes");
+
+        REQUIRE(container.is_compressed());
+
+        std::ifstream file("decomposed.mesh3");
+        std::stringstream contents;
+        contents << file.rdbuf();
+
+        REQUIRE(container.read(3) == contents.str());
+    }
+
+    std::remove("decomposed.meshes");
+}
+TEST_CASE("Tests for pipelined output")
+{
+    SECTION("Bounded queue")
+    {
+        bounded_queue<int> queue(2);
+
+        std::thread producer([&queue] {
+            for (int i = 0; i < 100; ++i) queue.push(i);
+            queue.close();
+        });
+
+        std::vector<int> items;
+        for (int item; queue.pop(item);) items.push_back(item);
+
+        producer.join();
+
+        REQUIRE(items.size() == 100);
+        REQUIRE(items.front() == 0);
+        REQUIRE(items.back() == 99);
+
+        REQUIRE(!queue.push(100));
+    }
+    SECTION("Parsing from blocks")
+    {
+        std::ifstream file("decomposed.msh");
+        std::stringstream contents;
+        contents << file.rdbuf();
+
+        // Small blocks split the tokens across the block boundaries
+        bounded_queue<std::string> blocks(2);
+        file_reader reader("decomposed.msh", blocks, 7);
+
+        queue_streambuf buffer(blocks);
+        std::istream stream(&buffer);
+
+        std::string token, expected;
+        while (contents >> expected)
+        {
+            REQUIRE(stream >> token);
+            REQUIRE(token == expected);
+        }
+        REQUIRE(!(stream >> token));
+
+        bounded_queue<std::string> missing(2);
+        REQUIRE_THROWS_AS(file_reader("missing.msh", missing), std::domain_error);
+    }
+    SECTION("Overlapped writes")
+    {
+        mesh_reader reader("decomposed.msh",
+                           NodalOrdering::Local,
+                           IndexingBase::Zero,
+                           distributed::interprocess);
+
+        output_options options;
+        reader.write(options);
+
+        std::vector<std::string> expected;
+        for (int partition = 0; partition < reader.numberOfPartitions(); ++partition)
+        {
+            std::ifstream file("decomposed.mesh" + std::to_string(partition));
+            std::stringstream contents;
+            contents << file.rdbuf();
+            expected.push_back(contents.str());
+
+            std::remove(("decomposed.mesh" + std::to_string(partition)).c_str());
+        }
+
+        options.pipeline = true;
+        reader.write(options);
+
+        for (int partition = 0; partition < reader.numberOfPartitions(); ++partition)
+        {
+            std::ifstream file("decomposed.mesh" + std::to_string(partition));
+            std::stringstream contents;
+            contents << file.rdbuf();
+
+            REQUIRE(contents.str() == expected[partition]);
+        }
+    }
+}
+TEST_CASE("Tests for the mesh cache")
+{
+    SECTION("Format changes")
+    {
+        mesh_reader reader("decomposed.msh",
+                           NodalOrdering::Global,
+                           IndexingBase::One,
+                           distributed::feti);
+
+        auto const global = reader.local_mesh(2);
+        REQUIRE(global->element_groups()[0].node_indices[0] == 9);
+
+        // Setting the same format keeps the assembled partitions
+        reader.set_format(NodalOrdering::Global, IndexingBase::One, distributed::feti);
+        REQUIRE(reader.local_mesh(2) == global);
+
+        reader.set_format(NodalOrdering::Local, IndexingBase::Zero, distributed::interprocess);
+        REQUIRE(reader.local_mesh(2)->element_groups()[0].node_indices[0] == 3);
+
+        // A partition held by the caller is kept when the format changes
+        REQUIRE(global->element_groups()[0].node_indices[0] == 9);
+
+        output_options options;
+        reader.write(options);
+
+        std::ifstream file("decomposed.mesh2");
+        std::stringstream contents;
+        contents << file.rdbuf();
+
+        REQUIRE(reader.write_partition(2, options) == contents.str());
+    }
+    SECTION("Least recently used meshes")
+    {
+        mesh_cache cache(1);
+
+        auto const decomposed = cache.get("decomposed.msh");
+
+        REQUIRE(cache.get("decomposed.msh") == decomposed);
+        REQUIRE(cache.hits() == 1);
+        REQUIRE(cache.misses() == 1);
+
+        REQUIRE(cache.get("basic.msh")->nodes().size() == 121);
+        REQUIRE(cache.size() == 1);
+
+        REQUIRE(cache.get("decomposed.msh") != decomposed);
+        REQUIRE(cache.misses() == 3);
+
+        REQUIRE_THROWS_AS(cache.get("missing.msh"), std::domain_error);
+    }
+    SECTION("Modified files")
+    {
+        mesh_cache cache(2);
+
+        {
+            std::ifstream source("decomposed.msh");
+            std::ofstream copy("cached.msh");
+            copy << source.rdbuf();
+        }
+        auto const original = cache.get("cached.msh");
+
+        REQUIRE(original->numberOfPartitions() == 4);
+
+        {
+            std::ifstream source("basic.msh");
+            std::ofstream copy("cached.msh");
+            copy << source.rdbuf();
+        }
+        REQUIRE(cache.get("cached.msh")->numberOfPartitions() == 1);
+        REQUIRE(cache.size() == 1);
+
+        std::remove("cached.msh");
+    }
+}
+TEST_CASE("Tests for uniform refinement")
+{
+    REQUIRE(element_refinement(HEXAHEDRON8).children.size() == 8);
+    REQUIRE(element_refinement(TETRAHEDRON4).new_nodes.size() == 6);
+    REQUIRE_THROWS_AS(element_refinement(TETRAHEDRON10), std::domain_error);
+
+    mesh_reader reader("decomposed.msh",
+                       NodalOrdering::Global,
+                       IndexingBase::One,
+                       distributed::feti);
+
+    reader.local_mesh(0);
+
+    reader.refine();
+
+    // Each quadrilateral is split into four with a new node on each of the
+    // twelve edges and in each of the four quadrilaterals
+    REQUIRE(reader.nodes().size() == 25);
+    REQUIRE(reader.nodes().max_id() == 25);
+    REQUIRE(reader.numberOfPartitions() == 4);
+
+    for (int partition = 0; partition < reader.numberOfPartitions(); ++partition)
+    {
+        auto const local = reader.local_mesh(partition);
+
+        REQUIRE(local->element_groups()[0].size() == 4);
+        REQUIRE(local->nodes().size() == 9);
+
+        // The interfaces hold the two nodes of a shared edge and its new node
+        for (auto const& interface : local->interfaces())
+        {
+            REQUIRE((interface.node_ids.size() == 3 || interface.node_ids.size() == 1));
+        }
+    }
+
+    // The new node on the edge from node 5 to node 9 lies at the midpoint
+    auto const& interface = reader.local_mesh(0)->interfaces()[0];
+    REQUIRE(interface.node_ids.front() == 5);
+    REQUIRE(interface.node_ids.back() > 9);
+
+    auto const midpoint = reader.nodes()[reader.nodes().slot(interface.node_ids.back())];
+    REQUIRE(midpoint.coordinates[0] == Approx(0.5));
+    REQUIRE(midpoint.coordinates[1] == Approx(0.25));
+
+    SECTION("Refined meshes are cached separately")
+    {
+        mesh_cache cache(2);
+
+        REQUIRE(cache.get("decomposed.msh")->nodes().size() == 9);
+        REQUIRE(cache.get("decomposed.msh", 2)->nodes().size() == 81);
+        REQUIRE(cache.size() == 2);
+    }
+}
+TEST_CASE("Tests for merging coincident nodes")
+{
+    // Two quadrilaterals on different partitions with separately numbered
+    // nodes on the shared edge
+    {
+        std::ofstream file("coincident.msh");
+        file << "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n"
+             << "$Nodes\n8\n"
+             << "1 0 0 0\n2 1 0 0\n3 1 1 0\n4 0 1 0\n"
+             << "5 1 0 0\n6 2 0 0\n7 2 1 0\n8 1 1.0000000000001 0\n"
+             << "$EndNodes\n$Elements\n2\n"
+             << "1 3 5 1 1 2 1 -2 1 2 3 4\n"
+             << "2 3 5 1 1 2 2 -1 5 6 7 8\n"
+             << "$EndElements\n";
+    }
+
+    mesh_reader reader("coincident.msh",
+                       NodalOrdering::Global,
+                       IndexingBase::One,
+                       distributed::feti);
+
+    REQUIRE(reader.local_mesh(0)->interfaces()[0].node_ids.empty());
+
+    REQUIRE(reader.merge_nodes(0.0) == 0);
+    REQUIRE(reader.nodes().size() == 8);
+
+    REQUIRE(reader.merge_nodes() == 2);
+    REQUIRE(reader.nodes().size() == 6);
+    REQUIRE(reader.nodes().ids() == std::vector<std::int64_t>{1, 2, 3, 4, 6, 7});
+
+    auto const& connectivity = reader.local_mesh(1)->element_groups()[0].node_indices;
+    REQUIRE(connectivity[0] == 2);
+    REQUIRE(connectivity[1] == 6);
+    REQUIRE(connectivity[2] == 7);
+    REQUIRE(connectivity[3] == 3);
+
+    // The partitions now share the nodes of the common edge
+    REQUIRE(reader.local_mesh(0)->interfaces()[0].node_ids == std::vector<std::int64_t>{2, 3});
+
+    REQUIRE(reader.merge_nodes() == 0);
+
+    std::remove("coincident.msh");
+}
+TEST_CASE("Tests for reduced precision coordinates")
+{
+    mesh_reader reader("basic.msh", NodalOrdering::Global, IndexingBase::One, distributed::feti);
+
+    auto const& nodes = reader.local_mesh(0)->nodes();
+
+    auto const parse = [&](output_options const& options) {
+        Json::Value event;
+        Json::Reader().parse(reader.write_partition(0, options), event);
+        return event;
+    };
+
+    output_options options;
+
+    REQUIRE(parse(options)["CoordinatePrecision"].isNull());
+
+    SECTION("Single precision")
+    {
+        options.precision = coordinate_precision::float32;
+
+        auto const event = parse(options);
+
+        REQUIRE(event["CoordinatePrecision"]["Type"].asString() == "float32");
+
+        auto const& coordinates = event["Nodes"][0]["Coordinates"];
+
+        REQUIRE(coordinates.size() == nodes.size());
+
+        for (Json::ArrayIndex slot = 0; slot < coordinates.size(); ++slot)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                REQUIRE(static_cast<float>(coordinates[slot][i].asDouble()) ==
+                        static_cast<float>(nodes.coordinates()[slot][i]));
+            }
+        }
+    }
+    SECTION("Quantised coordinates")
+    {
+        options.precision         = coordinate_precision::quantised;
+        options.quantisation_bits = 12;
+
+        auto const event = parse(options);
+
+        auto const& precision = event["CoordinatePrecision"];
+
+        REQUIRE(precision["Type"].asString() == "quantised");
+        REQUIRE(precision["Bits"].asInt() == 12);
+
+        auto const scale = precision["Scale"].asDouble();
+        auto const bound = precision["ErrorBound"].asDouble();
+
+        REQUIRE(bound > 0.0);
+
+        auto const& coordinates = event["Nodes"][0]["Coordinates"];
+
+        for (Json::ArrayIndex slot = 0; slot < coordinates.size(); ++slot)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                REQUIRE(coordinates[slot][i].isIntegral());
+                REQUIRE(coordinates[slot][i].asInt64() >= 0);
+                REQUIRE(coordinates[slot][i].asInt64() < 4096);
+
+                auto const decoded = precision["Origin"][i].asDouble() +
+                                     coordinates[slot][i].asInt64() * scale;
+
+                REQUIRE(std::abs(decoded - nodes.coordinates()[slot][i]) <= bound * 1.0001);
+            }
+        }
+
+        options.quantisation_bits = 0;
+        REQUIRE_THROWS_AS(parse(options), std::domain_error);
+    }
+}
+TEST_CASE("Tests for communication schedules")
+{
+    mesh_reader reader("decomposed.msh",
+                       NodalOrdering::Local,
+                       IndexingBase::Zero,
+                       distributed::interprocess);
+
+    auto const global_ids = [](partition const& local, std::vector<std::int64_t> const& ids) {
+        std::vector<std::int64_t> global;
+        for (auto const id : ids) global.push_back(local.local_to_global()[id]);
+        return global;
+    };
+
+    std::int64_t exchanged = 0;
+
+    for (int p = 0; p < reader.numberOfPartitions(); ++p)
+    {
+        auto const local = reader.local_mesh(p);
+
+        for (auto const& interface : local->interfaces())
+        {
+            auto const neighbour = reader.local_mesh(interface.master);
+
+            auto const found = std::find_if(neighbour->interfaces().begin(),
+                                            neighbour->interfaces().end(),
+                                            [p](auto const& other) { return other.master == p; });
+
+            REQUIRE(found != neighbour->interfaces().end());
+
+            // The nodes sent are received in the same order by the neighbour
+            REQUIRE(global_ids(*local, interface.send_ids) ==
+                    global_ids(*neighbour, found->receive_ids));
+            REQUIRE(global_ids(*local, interface.receive_ids) ==
+                    global_ids(*neighbour, found->send_ids));
+
+            auto const& shared = interface.node_ids;
+
+            for (auto const node : global_ids(*local, interface.send_ids))
+            {
+                REQUIRE(std::binary_search(begin(shared), end(shared), node));
+            }
+            // Nodes are owned by the lowest numbered partition
+            if (p > interface.master) REQUIRE(interface.send_ids.empty());
+
+            exchanged += interface.send_ids.size();
+        }
+    }
+    REQUIRE(exchanged > 0);
+}
+TEST_CASE("Tests for interfaces from shared nodes")
+{
+    // Write the decomposed mesh without the ghost partition tags
+    {
+        std::ifstream source("decomposed.msh");
+        std::ofstream file("decomposed_no_ghosts.msh");
+
+        std::string line;
+        bool is_element = false;
+
+        while (std::getline(source, line))
+        {
+            if (line == "$EndElements") is_element = false;
+
+            std::istringstream tokens(line);
+            std::vector<std::int64_t> values;
+            for (std::int64_t value; tokens >> value;) values.push_back(value);
+
+            if (is_element && values.size() > 4)
+            {
+                // id, type, 3 tags, physical, geometric, one partition, owner
+                file << values[0] << " " << values[1] << " 4 " << values[3] << " " << values[4]
+                     << " 1 " << values[6];
+
+                for (std::size_t i = 3 + values[2]; i < values.size(); ++i)
+                {
+                    file << " " << values[i];
+                }
+                file << "\n";
+            }
+            else
+            {
+                file << line << "\n";
+            }
+            if (line == "$Elements") is_element = true;
+        }
+    }
+
+    for (auto const format : {distributed::feti, distributed::interprocess})
+    {
+        mesh_reader ghosts("decomposed.msh", NodalOrdering::Global, IndexingBase::One, format);
+        mesh_reader shared("decomposed_no_ghosts.msh",
+                           NodalOrdering::Global,
+                           IndexingBase::One,
+                           format);
+
+        mesh_reader forced("decomposed.msh", NodalOrdering::Global, IndexingBase::One, format);
+
+        forced.set_interface_detection(interface_detection::shared_nodes);
+
+        REQUIRE(shared.numberOfPartitions() == ghosts.numberOfPartitions());
+
+        for (int p = 0; p < ghosts.numberOfPartitions(); ++p)
+        {
+            auto const& expected = ghosts.local_mesh(p)->interfaces();
+
+            REQUIRE(!expected.empty());
+
+            for (auto const reader : {&shared, &forced})
+            {
+                auto const& found = reader->local_mesh(p)->interfaces();
+
+                REQUIRE(found.size() == expected.size());
+
+                for (std::size_t i = 0; i < found.size(); ++i)
+                {
+                    REQUIRE(found[i].master == expected[i].master);
+                    REQUIRE(found[i].slave == expected[i].slave);
+                    REQUIRE(found[i].global_start_id == expected[i].global_start_id);
+                    REQUIRE(found[i].node_ids == expected[i].node_ids);
+                }
+                REQUIRE(reader->local_mesh(p)->interface_nodes() ==
+                        ghosts.local_mesh(p)->interface_nodes());
+            }
+        }
+    }
+
+    // A partition read through the index finds the interfaces from the
+    // elements of the neighbours sharing its nodes
+    for (auto const format : {distributed::feti, distributed::interprocess})
+    {
+        output_options options;
+        options.print_indices = true;
+
+        mesh_reader complete("decomposed_no_ghosts.msh",
+                             NodalOrdering::Local,
+                             IndexingBase::One,
+                             format);
+
+        mesh_reader forced("decomposed.msh", NodalOrdering::Local, IndexingBase::One, format);
+
+        forced.set_interface_detection(interface_detection::shared_nodes);
+
+        for (int p = 0; p < complete.numberOfPartitions(); ++p)
+        {
+            mesh_reader extracted("decomposed_no_ghosts.msh",
+                                  p,
+                                  NodalOrdering::Local,
+                                  IndexingBase::One,
+                                  format);
+
+            REQUIRE(!extracted.local_mesh(p)->interfaces().empty());
+            REQUIRE(extracted.write_partition(p, options) == complete.write_partition(p, options));
+
+            mesh_reader extracted_forced("decomposed.msh",
+                                         p,
+                                         NodalOrdering::Local,
+                                         IndexingBase::One,
+                                         format);
+
+            extracted_forced.set_interface_detection(interface_detection::shared_nodes);
+
+            REQUIRE(extracted_forced.write_partition(p, options) ==
+                    forced.write_partition(p, options));
+        }
+    }
+
+    std::remove(index_file_name("decomposed_no_ghosts.msh").c_str());
+    std::remove(index_file_name("decomposed.msh").c_str());
+    std::remove("decomposed_no_ghosts.msh");
+}
+TEST_CASE("Tests for partition statistics")
+{
+    mesh_reader reader("decomposed.msh",
+                       NodalOrdering::Local,
+                       IndexingBase::Zero,
+                       distributed::feti);
+
+    // Four quadrilaterals on a two by two grid, each in its own partition
+    auto const statistics = reader.statistics();
+
+    REQUIRE(statistics.partitions.size() == 4);
+
+    for (int p = 0; p < 4; ++p)
+    {
+        auto const& partition = statistics.partitions[p];
+
+        REQUIRE(partition.number == p);
+        REQUIRE(partition.elements == 1);
+        REQUIRE(partition.cost == Approx(element_cost(4)));
+        REQUIRE(partition.nodes == 4);
+        REQUIRE(partition.interface_nodes == 3);
+        REQUIRE(partition.neighbours == 3);
+        REQUIRE(partition.cut_faces == 2);
+    }
+    REQUIRE(statistics.edge_cut == 4);
+    REQUIRE(statistics.element_imbalance == Approx(1.0));
+    REQUIRE(statistics.interface_imbalance == Approx(1.0));
+
+    SECTION("Imbalance ratios")
+    {
+        std::vector<partition_statistics> partitions(2);
+        partitions[0].elements = 3;
+        partitions[1].elements = 1;
+
+        auto const summary = summarise(partitions);
+
+        REQUIRE(summary.element_imbalance == Approx(1.5));
+        REQUIRE(summary.node_imbalance == Approx(1.0));
+        REQUIRE(summary.edge_cut == 0);
+    }
+    SECTION("Report written with the output")
+    {
+        output_options options;
+        options.statistics = true;
+
+        reader.write(options);
+
+        std::ifstream file("decomposed.stats.json");
+        Json::Value event;
+        file >> event;
+
+        REQUIRE(event["EdgeCut"].asInt64() == 4);
+        REQUIRE(event["Partitions"].size() == 4);
+        REQUIRE(event["Partitions"][2]["InterfaceNodes"].asInt64() == 3);
+        REQUIRE(event["Imbalance"]["Cost"].asDouble() == Approx(1.0));
+
+        std::remove("decomposed.stats.json");
+    }
+}
+TEST_CASE("Tests for single partition extraction")
+{
+    std::remove(index_file_name("decomposed.msh").c_str());
+
+    SECTION("Sidecar index")
+    {
+        auto const index = build_mesh_index("decomposed.msh", 2);
+
+        REQUIRE(index.partitions == 4);
+        REQUIRE(index.physical_names.size() == 1);
+        REQUIRE(index.node_blocks.size() == 5);
+        REQUIRE(index.node_blocks[0].count == 2);
+        REQUIRE(index.element_runs.size() == 4);
+        REQUIRE(index.element_runs[0].owner == 2);
+        REQUIRE(index.element_runs[0].ghosts == std::vector<std::int32_t>{1, 3, 4});
+        REQUIRE(index.upper[0] > index.lower[0]);
+
+        write_mesh_index(index, "decomposed.msh");
+
+        auto const read = open_mesh_index("decomposed.msh");
+
+        REQUIRE(read.file_size == index.file_size);
+        REQUIRE(read.modified == index.modified);
+        REQUIRE(read.node_blocks[4].first_id == index.node_blocks[4].first_id);
+        REQUIRE(read.element_runs[3].first_id == index.element_runs[3].first_id);
+        REQUIRE(read.node_blocks.size() == index.node_blocks.size());
+        REQUIRE(read.node_blocks[4].offset == index.node_blocks[4].offset);
+        REQUIRE(read.element_runs[3].offset == index.element_runs[3].offset);
+        REQUIRE(read.interfaces.size() == index.interfaces.size());
+        REQUIRE(read.interface_nodes == index.interface_nodes);
+        REQUIRE(read.shared_node_interfaces.size() == index.shared_node_interfaces.size());
+        REQUIRE(read.shared_interface_nodes == index.shared_interface_nodes);
+        REQUIRE(read.element_runs[0].neighbours == index.element_runs[0].neighbours);
+        REQUIRE(read.upper == index.upper);
+    }
+    SECTION("Partitions match the complete mesh")
+    {
+        output_options options;
+        options.print_indices = true;
+
+        for (auto const format : {distributed::feti, distributed::interprocess})
+        {
+            mesh_reader complete("decomposed.msh", NodalOrdering::Local, IndexingBase::One, format);
+
+            for (int p = 0; p < complete.numberOfPartitions(); ++p)
+            {
+                mesh_reader extracted("decomposed.msh",
+                                      p,
+                                      NodalOrdering::Local,
+                                      IndexingBase::One,
+                                      format);
+
+                REQUIRE(extracted.numberOfPartitions() == complete.numberOfPartitions());
+                REQUIRE(extracted.write_partition(p, options) ==
+                        complete.write_partition(p, options));
+
+                REQUIRE_THROWS_AS(extracted.local_mesh((p + 1) % 4), std::out_of_range);
+            }
+        }
+    }
+    SECTION("Stale index")
+    {
+        // An index with the size and modification time of the mesh but with
+        // locations that do not hold the indexed lines is rebuilt
+        auto index = build_mesh_index("decomposed.msh");
+
+        for (auto& run : index.element_runs) run.offset += 1;
+        for (auto& block : index.node_blocks) block.offset += 1;
+
+        write_mesh_index(index, "decomposed.msh");
+
+        output_options options;
+
+        mesh_reader complete("decomposed.msh",
+                             NodalOrdering::Local,
+                             IndexingBase::One,
+                             distributed::feti);
+
+        mesh_reader extracted("decomposed.msh",
+                              1,
+                              NodalOrdering::Local,
+                              IndexingBase::One,
+                              distributed::feti);
+
+        REQUIRE(extracted.write_partition(1, options) == complete.write_partition(1, options));
+
+        REQUIRE(open_mesh_index("decomposed.msh").element_runs[0].offset ==
+                index.element_runs[0].offset - 1);
+    }
+    SECTION("Unsupported operations")
+    {
+        mesh_reader extracted("decomposed.msh",
+                              1,
+                              NodalOrdering::Global,
+                              IndexingBase::One,
+                              distributed::feti);
+
+        REQUIRE_THROWS_AS(extracted.refine(), std::domain_error);
+        REQUIRE_THROWS_AS(extracted.merge_nodes(), std::domain_error);
+        REQUIRE_THROWS_AS(extracted.statistics(), std::domain_error);
+
+        output_options options;
+        options.statistics = true;
+
+        REQUIRE_THROWS_AS(extracted.write(options), std::domain_error);
+
+        REQUIRE_THROWS_AS(mesh_reader("decomposed.msh",
+                                      4,
+                                      NodalOrdering::Global,
+                                      IndexingBase::One,
+                                      distributed::feti),
+                          std::out_of_range);
+    }
+
+    std::remove(index_file_name("decomposed.msh").c_str());
+}